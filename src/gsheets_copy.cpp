@@ -1,13 +1,20 @@
 #include "gsheets_copy.hpp"
 #include "gsheets_requests.hpp"
 #include "gsheets_auth.hpp"
+#include "gsheets_disk_cache.hpp"
+#include "gsheets_memory_cache.hpp"
+#include "gsheets_metadata_cache.hpp"
 #include "gsheets_utils.hpp"
 
 #include "duckdb/common/serializer/buffered_file_writer.hpp"
 #include "duckdb/common/file_system.hpp"
+#include "duckdb/common/string_util.hpp"
 #include "duckdb/main/secret/secret_manager.hpp"
 #include <json.hpp>
 
+#include <algorithm>
+#include <cstdio>
+
 using json = nlohmann::json;
 
 namespace duckdb
@@ -19,14 +26,571 @@ namespace duckdb
         copy_to_initialize_global = GSheetWriteInitializeGlobal;
         copy_to_initialize_local = GSheetWriteInitializeLocal;
         copy_to_sink = GSheetWriteSink;
+        copy_to_combine = GSheetWriteCombine;
+        copy_to_finalize = GSheetWriteFinalize;
+        execution_mode = GSheetWriteExecutionMode;
+    }
+
+    // Parses a positive integer option of COPY TO
+    static idx_t ParsePositiveOption(const string &name, const vector<Value> &values)
+    {
+        if (values.size() != 1)
+        {
+            throw BinderException("COPY TO gsheet option %s expects a single value", name);
+        }
+        int64_t value = values[0].GetValue<int64_t>();
+        if (value <= 0)
+        {
+            throw BinderException("COPY TO gsheet option %s must be a positive integer", name);
+        }
+        return static_cast<idx_t>(value);
+    }
+
+    static SheetRowFormat GetRowFormat(const GSheetWriteOptions &options)
+    {
+        return options.write_method == GSheetWriteMethod::CELLS ? SheetRowFormat::CELLS : SheetRowFormat::VALUES;
+    }
+
+    // Sets the size of the grid of the sheet
+    static HttpResponse ResizeGrid(const GSheetCopyGlobalState &gstate, idx_t rows, idx_t columns)
+    {
+        json update_properties;
+        update_properties["properties"]["sheetId"] = std::stoll(gstate.sheet_id);
+        update_properties["properties"]["gridProperties"] = {{"rowCount", rows}, {"columnCount", columns}};
+        update_properties["fields"] = "gridProperties.rowCount,gridProperties.columnCount";
+        json request;
+        request["requests"].push_back({{"updateSheetProperties", update_properties}});
+        return batch_update_spreadsheet(gstate.spreadsheet_id, gstate.token, gstate.request_settings, request.dump());
+    }
+
+    static void CheckResize(const HttpResponse &response)
+    {
+        if (!response.IsSuccess())
+        {
+            throw duckdb::IOException("Error resizing Google Sheet: " + get_response_error(response));
+        }
     }
 
+    // Adds a sheet to the spreadsheet, with a grid as wide as the columns written
+    static SheetProperties AddSheet(const string &spreadsheet_id, const string &token, const RequestSettings &settings,
+                                    const string &title, idx_t columns)
+    {
+        idx_t rows = GSheetCopyGlobalState::NEW_SHEET_ROWS;
+        json properties;
+        properties["title"] = title;
+        properties["gridProperties"] = {{"rowCount", rows}, {"columnCount", columns}};
+        json request;
+        request["requests"].push_back({{"addSheet", {{"properties", properties}}}});
+        HttpResponse response = batch_update_spreadsheet(spreadsheet_id, token, settings, request.dump());
+        if (!response.IsSuccess())
+        {
+            throw duckdb::IOException("Error adding sheet to Google Sheet: " + get_response_error(response));
+        }
+        auto sheet_id = parseJson(response.body).value(json::json_pointer("/replies/0/addSheet/properties/sheetId"), int64_t(0));
+        return SheetProperties {std::to_string(sheet_id), title, rows, columns};
+    }
+
+    // Hands out the sheet rows [first_row, first_row + row_count) to a batch, growing the grid to hold them. Every
+    // batch gets its own rows, so batches can be written by any thread in any order. The grid grows ahead of the
+    // rows, doubling up to MAX_GROW_AHEAD_ROWS rows at a time, so a long copy resizes it a handful of times rather
+    // than once per batch. Rows grown but not written are trimmed by finalize. One thread grows the grid at a time,
+    // outside of the lock, so other threads keep reserving rows within the grid while it does.
+    static idx_t ReserveRows(GSheetCopyGlobalState &gstate, idx_t row_count)
+    {
+        unique_lock<mutex> guard(gstate.lock);
+        idx_t first_row = gstate.next_row;
+        gstate.next_row += row_count;
+        idx_t last_row = gstate.next_row - 1;
+        while (last_row > gstate.grid_rows)
+        {
+            if (gstate.growing_grid)
+            {
+                gstate.rows_changed.wait(guard);
+                continue;
+            }
+            // Grown for every row reserved so far, not only the rows of this batch
+            idx_t reserved_rows = gstate.next_row - 1;
+            idx_t rows = MaxValue(reserved_rows, MinValue(gstate.grid_rows * 2, reserved_rows + GSheetCopyGlobalState::MAX_GROW_AHEAD_ROWS));
+            gstate.growing_grid = true;
+            guard.unlock();
+            HttpResponse response;
+            try
+            {
+                response = ResizeGrid(gstate, rows, gstate.grid_columns);
+                if (!response.IsSuccess() && rows > reserved_rows)
+                {
+                    // Rows grown ahead can exceed the cell limit of the spreadsheet even when the rows written fit in it
+                    rows = reserved_rows;
+                    response = ResizeGrid(gstate, rows, gstate.grid_columns);
+                }
+            }
+            catch (...)
+            {
+                guard.lock();
+                gstate.growing_grid = false;
+                gstate.rows_changed.notify_all();
+                throw;
+            }
+            guard.lock();
+            gstate.growing_grid = false;
+            gstate.rows_changed.notify_all();
+            CheckResize(response);
+            gstate.grid_rows = MaxValue(gstate.grid_rows, rows);
+        }
+        return first_row;
+    }
+
+    // Waits for a write submitted by WriteRows, and throws if it failed
+    static void CompleteWrite(std::future<HttpResponse> &write)
+    {
+        HttpResponse response = write.get();
+        if (!response.IsSuccess())
+        {
+            throw duckdb::IOException("Error writing to Google Sheet: " + get_response_error(response));
+        }
+    }
+
+    // Tracks a write submitted in the background, so the next rows can be encoded while it is in flight. Once
+    // MAX_PENDING_WRITES writes are pending, the oldest one is waited for first.
+    static void SubmitWrite(GSheetCopyGlobalState &gstate, std::future<HttpResponse> write)
+    {
+        std::future<HttpResponse> oldest;
+        {
+            lock_guard<mutex> guard(gstate.lock);
+            gstate.pending_writes.push_back(std::move(write));
+            if (gstate.pending_writes.size() > GSheetCopyGlobalState::MAX_PENDING_WRITES)
+            {
+                oldest = std::move(gstate.pending_writes.front());
+                gstate.pending_writes.pop_front();
+            }
+        }
+        // Waited for outside of the lock, so other threads can submit their rows in the meantime
+        if (oldest.valid())
+        {
+            CompleteWrite(oldest);
+        }
+    }
+
+    // The last row of an A1 range, e.g. 10 for 'Sheet1'!A5:C10
+    static idx_t GetRangeLastRow(const string &range)
+    {
+        auto end = range.size();
+        auto start = end;
+        while (start > 0 && StringUtil::CharacterIsDigit(range[start - 1]))
+        {
+            start--;
+        }
+        if (start == end)
+        {
+            throw duckdb::IOException("Unexpected range in response of Google Sheets API: " + range);
+        }
+        return std::stoull(range.substr(start));
+    }
+
+    // In append mode, the first batch is written with values:append, which puts it below the table already in the
+    // sheet. Later batches are written to the rows following it, like in overwrite mode. Returns false once the end
+    // of the table is known.
+    static bool AppendFirstRows(GSheetCopyGlobalState &gstate, const GSheetRowBuffer &buffer)
+    {
+        unique_lock<mutex> guard(gstate.lock);
+        // The rows of other batches follow the appended rows, so they wait for the append to tell where it ended
+        while (gstate.appending)
+        {
+            gstate.rows_changed.wait(guard);
+        }
+        if (!gstate.append_at_end)
+        {
+            return false;
+        }
+        gstate.appending = true;
+        guard.unlock();
+        HttpResponse response;
+        try
+        {
+            std::string range = quote_sheet_name(gstate.sheet_name) + "!A1:" + gstate.last_column + "1";
+            std::string request_body = "{\"majorDimension\":\"ROWS\",\"values\":[" + buffer.values + "]}";
+            response = append_sheet_values(gstate.spreadsheet_id, gstate.token, gstate.request_settings, url_encode(range), request_body, gstate.value_input_option);
+        }
+        catch (...)
+        {
+            guard.lock();
+            gstate.appending = false;
+            gstate.rows_changed.notify_all();
+            throw;
+        }
+        guard.lock();
+        gstate.appending = false;
+        gstate.rows_changed.notify_all();
+        if (!response.IsSuccess())
+        {
+            throw duckdb::IOException("Error appending to Google Sheet: " + get_response_error(response));
+        }
+        auto updated_range = parseJson(response.body).value(json::json_pointer("/updates/updatedRange"), string());
+        idx_t last_row = GetRangeLastRow(updated_range);
+        gstate.next_row = last_row + 1;
+        gstate.grid_rows = MaxValue(gstate.grid_rows, last_row);
+        gstate.append_at_end = false;
+        return true;
+    }
+
+    // Writes the buffered rows to the next free rows of the sheet in a single values:update request, or a single
+    // updateCells request when the rows are cells
+    static void WriteRows(GSheetCopyGlobalState &gstate, const GSheetRowBuffer &buffer)
+    {
+        if (buffer.row_count == 0 || AppendFirstRows(gstate, buffer))
+        {
+            return;
+        }
+        idx_t first_row = ReserveRows(gstate, buffer.row_count);
+        if (gstate.write_method == GSheetWriteMethod::CELLS)
+        {
+            std::string request_body;
+            request_body.reserve(buffer.values.size() + 256);
+            request_body += "{\"requests\":[{\"updateCells\":{\"start\":{\"sheetId\":" + gstate.sheet_id +
+                            ",\"rowIndex\":" + std::to_string(first_row - 1) + ",\"columnIndex\":0}," +
+                            "\"fields\":\"userEnteredValue,userEnteredFormat.numberFormat\",\"rows\":[";
+            request_body += buffer.values;
+            request_body += "]}}]}";
+            SubmitWrite(gstate, batch_update_spreadsheet_async(gstate.spreadsheet_id, gstate.token, gstate.request_settings, request_body));
+            return;
+        }
+        std::string range = quote_sheet_name(gstate.sheet_name) + "!A" + std::to_string(first_row) + ":" +
+                            gstate.last_column + std::to_string(first_row + buffer.row_count - 1);
+
+        std::string request_body;
+        request_body.reserve(buffer.values.size() + 64);
+        request_body += "{\"majorDimension\":\"ROWS\",\"values\":[";
+        request_body += buffer.values;
+        request_body += "]}";
+
+        SubmitWrite(gstate, update_sheet_values_async(gstate.spreadsheet_id, gstate.token, gstate.request_settings, url_encode(range), request_body,
+                                                      gstate.value_input_option));
+    }
+
+    // Waits for every pending write
+    static void CompletePendingWrites(GSheetCopyGlobalState &gstate)
+    {
+        std::deque<std::future<HttpResponse>> pending;
+        {
+            lock_guard<mutex> guard(gstate.lock);
+            std::swap(pending, gstate.pending_writes);
+        }
+        for (auto &write : pending)
+        {
+            CompleteWrite(write);
+        }
+    }
+
+    // Without an explicit BATCH_SIZE, batches hold more rows as the write budget of the user runs out. Their bytes
+    // stay bounded by BATCH_BYTES, which keeps requests within the payload limits of the API.
+    static idx_t GetBatchScale(const GSheetWriteOptions &options, const GSheetCopyGlobalState &gstate)
+    {
+        return options.adaptive_batch_size ? get_batch_scale(gstate.token, gstate.request_settings, HttpMethod::PUT) : 1;
+    }
+
+    static bool BufferIsFull(const GSheetWriteOptions &options, const GSheetRowBuffer &buffer, idx_t scale)
+    {
+        return buffer.row_count >= options.batch_size * scale || buffer.values.size() >= options.batch_bytes;
+    }
+
+
+    // The text a cell of the sheet is compared by in a merge, the form SheetRowEncoder::GetComparableRow gives the
+    // cells written: strings as they are, numbers by AppendComparableNumber, and booleans as TRUE or FALSE. Empty
+    // strings, nulls and missing cells are all the empty cell.
+    static string CanonicalCell(const json &cell)
+    {
+        if (cell.is_string())
+        {
+            return cell.get<string>();
+        }
+        if (cell.is_number())
+        {
+            string result;
+            SheetRowEncoder::AppendComparableNumber(cell.get<double>(), result);
+            return result;
+        }
+        if (cell.is_boolean())
+        {
+            return cell.get<bool>() ? "TRUE" : "FALSE";
+        }
+        return string();
+    }
+
+    static vector<string> CanonicalRow(const json &row, idx_t width)
+    {
+        vector<string> cells(width);
+        for (idx_t i = 0; i < width && i < row.size(); i++)
+        {
+            cells[i] = CanonicalCell(row[i]);
+        }
+        return cells;
+    }
+
+    static string RowKey(const vector<string> &cells, const vector<idx_t> &key_columns)
+    {
+        string key;
+        for (auto col : key_columns)
+        {
+            key += cells[col];
+            key += '\x1f';
+        }
+        return key;
+    }
+
+    // Throws unless the header row of the sheet names the columns written, in order
+    static void CheckHeader(const GSheetCopyGlobalState &gstate, const vector<string> &names, const json &row, const string &action)
+    {
+        auto header = CanonicalRow(row, names.size());
+        for (idx_t i = 0; i < names.size(); i++)
+        {
+            if (header[i] != names[i])
+            {
+                throw InvalidInputException("Cannot %s sheet '%s': its header does not match the columns written",
+                                            action, gstate.sheet_name);
+            }
+        }
+    }
+
+    // Reads the sheet a merge writes into, and indexes its rows by key. Cells are read both unformatted, which is how
+    // dates and numbers compare with the values written, and formatted, which is how text the sheet parsed on entry
+    // compares, e.g. "$1,000" stored as the number 1000. Returns the number of sheet rows holding values, 0 if the
+    // sheet is empty.
+    static idx_t LoadExistingRows(GSheetCopyGlobalState &gstate, const GSheetWriteOptions &options)
+    {
+        auto &names = options.name_list;
+        vector<string> range {url_encode(quote_sheet_name(gstate.sheet_name))};
+        auto unformatted = batch_get_sheet_values_async(gstate.spreadsheet_id, gstate.token, gstate.request_settings, range,
+                                                        "&valueRenderOption=UNFORMATTED_VALUE&dateTimeRenderOption=SERIAL_NUMBER");
+        auto formatted = batch_get_sheet_values_async(gstate.spreadsheet_id, gstate.token, gstate.request_settings, range);
+        json rows;
+        json formatted_rows;
+        for (auto *request : {&unformatted, &formatted})
+        {
+            HttpResponse response = request->get();
+            if (!response.IsSuccess())
+            {
+                throw duckdb::IOException("Error reading Google Sheet to merge into: " + get_response_error(response));
+            }
+            auto values = parseJson(response.body).value(json::json_pointer("/valueRanges/0/values"), json::array());
+            (request == &unformatted ? rows : formatted_rows) = std::move(values);
+        }
+        if (rows.empty())
+        {
+            return 0;
+        }
+        CheckHeader(gstate, names, rows[0], "merge into");
+        for (idx_t r = 1; r < rows.size(); r++)
+        {
+            GSheetExistingRow existing {r + 1, CanonicalRow(rows[r], names.size()),
+                                        CanonicalRow(r < formatted_rows.size() ? formatted_rows[r] : json::array(), names.size())};
+            auto key = RowKey(existing.cells, options.key_columns);
+            auto formatted_key = RowKey(existing.formatted_cells, options.key_columns);
+            // The first row of a key is the one updated. Keys match by either form.
+            if (formatted_key != key)
+            {
+                gstate.existing_rows.emplace(std::move(formatted_key), existing);
+            }
+            gstate.existing_rows.emplace(std::move(key), std::move(existing));
+        }
+        return rows.size();
+    }
+
+    // Whether a row written differs from the row of the sheet holding its key, cells match either form of the sheet
+    // cell
+    static bool RowChanged(const vector<string> &cells, const GSheetExistingRow &existing)
+    {
+        for (idx_t i = 0; i < cells.size(); i++)
+        {
+            if (cells[i] != existing.cells[i] && cells[i] != existing.formatted_cells[i])
+            {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    // Throws if a key of the chunk was already written by the copy, a merge writes each key once
+    static void CheckUniqueKeys(GSheetCopyGlobalState &gstate, const GSheetWriteOptions &options, const vector<string> &keys)
+    {
+        lock_guard<mutex> guard(gstate.lock);
+        for (auto &key : keys)
+        {
+            if (!gstate.merged_keys.insert(key).second)
+            {
+                string values;
+                for (idx_t start = 0, i = 0; i < options.key_columns.size(); i++)
+                {
+                    auto end = key.find('\x1f', start);
+                    values += (i > 0 ? ", " : "") + key.substr(start, end - start);
+                    start = end + 1;
+                }
+                throw InvalidInputException("COPY TO gsheet with MODE 'merge': duplicate UPSERT_KEY value (%s), each key "
+                                            "may only be written once",
+                                            values);
+            }
+        }
+    }
+
+    // Writes changed rows of a merge over the rows holding their keys, in a single values:batchUpdate. Runs of
+    // adjacent rows are written as one range.
+    static void WriteUpdates(GSheetCopyGlobalState &gstate, GSheetRowUpdates &updates)
+    {
+        auto &rows = updates.rows;
+        if (rows.empty())
+        {
+            return;
+        }
+        std::sort(rows.begin(), rows.end(),
+                  [](const std::pair<idx_t, string> &a, const std::pair<idx_t, string> &b) { return a.first < b.first; });
+
+        std::string request_body;
+        request_body.reserve(updates.bytes + rows.size() * 64);
+        request_body += "{\"valueInputOption\":\"" + gstate.value_input_option + "\",\"data\":[";
+        for (idx_t i = 0; i < rows.size();)
+        {
+            idx_t end = i + 1;
+            while (end < rows.size() && rows[end].first == rows[end - 1].first + 1)
+            {
+                end++;
+            }
+            std::string range = quote_sheet_name(gstate.sheet_name) + "!A" + std::to_string(rows[i].first) + ":" +
+                                gstate.last_column + std::to_string(rows[end - 1].first);
+            if (i > 0)
+            {
+                request_body += ',';
+            }
+            request_body += "{\"range\":" + json(range).dump() + ",\"majorDimension\":\"ROWS\",\"values\":[";
+            for (idx_t k = i; k < end; k++)
+            {
+                if (k > i)
+                {
+                    request_body += ',';
+                }
+                request_body += rows[k].second;
+            }
+            request_body += "]}";
+            i = end;
+        }
+        request_body += "]}";
+        SubmitWrite(gstate, batch_update_sheet_values_async(gstate.spreadsheet_id, gstate.token, gstate.request_settings, request_body));
+    }
+
+    static bool UpdatesAreFull(const GSheetWriteOptions &options, const GSheetRowUpdates &updates, idx_t scale)
+    {
+        return updates.rows.size() >= options.batch_size * scale || updates.bytes >= options.batch_bytes;
+    }
 
     unique_ptr<FunctionData> GSheetCopyFunction::GSheetWriteBind(ClientContext &context, CopyFunctionBindInput &input, const vector<string> &names, const vector<LogicalType> &sql_types)
     {
         string file_path = input.info.file_path;
 
-        return make_uniq<GSheetWriteBindData>(file_path, sql_types, names);
+        auto bind_data = make_uniq<GSheetWriteBindData>(file_path, sql_types, names);
+        for (auto &option : input.info.options)
+        {
+            auto name = StringUtil::Lower(option.first);
+            if (name == "batch_size")
+            {
+                bind_data->options.batch_size = ParsePositiveOption("BATCH_SIZE", option.second);
+                bind_data->options.adaptive_batch_size = false;
+            }
+            else if (name == "batch_bytes")
+            {
+                bind_data->options.batch_bytes = ParsePositiveOption("BATCH_BYTES", option.second);
+            }
+            else if (name == "mode")
+            {
+                auto mode = option.second.size() == 1 ? StringUtil::Lower(option.second[0].ToString()) : string();
+                if (mode != "merge" && mode != "overwrite")
+                {
+                    throw BinderException("COPY TO gsheet option MODE must be 'overwrite' or 'merge'");
+                }
+                bind_data->options.merge = mode == "merge";
+            }
+            else if (name == "upsert_key")
+            {
+                for (auto &value : option.second)
+                {
+                    auto key = value.ToString();
+                    auto column = std::find(names.begin(), names.end(), key);
+                    if (column == names.end())
+                    {
+                        throw BinderException("COPY TO gsheet option UPSERT_KEY: column \"%s\" is not written", key);
+                    }
+                    bind_data->options.key_columns.push_back(column - names.begin());
+                }
+            }
+            else if (name == "append" || name == "overwrite")
+            {
+                if (option.second.size() > 1)
+                {
+                    throw BinderException("COPY TO gsheet option %s expects a single value", StringUtil::Upper(name));
+                }
+                // A flag given without a value is true
+                bool value = option.second.empty() || option.second[0].GetValue<bool>();
+                bind_data->options.append = name == "append" ? value : !value;
+            }
+            else if (name == "write_method")
+            {
+                auto method = option.second.size() == 1 ? StringUtil::Lower(option.second[0].ToString()) : string();
+                if (method != "values" && method != "cells")
+                {
+                    throw BinderException("COPY TO gsheet option WRITE_METHOD must be 'values' or 'cells'");
+                }
+                bind_data->options.write_method = method == "cells" ? GSheetWriteMethod::CELLS : GSheetWriteMethod::VALUES;
+            }
+            else if (name == "value_input_option")
+            {
+                auto input_option = option.second.size() == 1 ? StringUtil::Upper(option.second[0].ToString()) : string();
+                if (input_option != "RAW" && input_option != "USER_ENTERED")
+                {
+                    throw BinderException("COPY TO gsheet option VALUE_INPUT_OPTION must be 'raw' or 'user_entered'");
+                }
+                bind_data->options.value_input_option = input_option;
+            }
+            else if (name == "sheet")
+            {
+                if (option.second.size() != 1 || option.second[0].ToString().empty())
+                {
+                    throw BinderException("COPY TO gsheet option SHEET expects a sheet name");
+                }
+                bind_data->options.sheet = option.second[0].ToString();
+            }
+            else
+            {
+                throw BinderException("Unrecognized option for COPY TO gsheet: %s", option.first);
+            }
+        }
+        if (bind_data->options.merge != !bind_data->options.key_columns.empty())
+        {
+            throw BinderException("COPY TO gsheet options MODE 'merge' and UPSERT_KEY must be given together");
+        }
+        if (bind_data->options.append && bind_data->options.merge)
+        {
+            throw BinderException("COPY TO gsheet option APPEND cannot be combined with MODE 'merge'");
+        }
+        auto &options = bind_data->options;
+        if (options.write_method == GSheetWriteMethod::CELLS)
+        {
+            // Merges compare and appends place rows by their values
+            if (options.merge || options.append)
+            {
+                throw BinderException("COPY TO gsheet option WRITE_METHOD 'cells' cannot be combined with MODE 'merge' or APPEND");
+            }
+            if (!options.value_input_option.empty())
+            {
+                throw BinderException("COPY TO gsheet option VALUE_INPUT_OPTION only applies to WRITE_METHOD 'values'");
+            }
+        }
+        if (options.value_input_option.empty())
+        {
+            // Numbers and booleans are written as JSON numbers and booleans, which need no parsing. Every other type
+            // is written as text, which is parsed so that e.g. dates written as text become dates
+            bool raw = std::all_of(sql_types.begin(), sql_types.end(), [](const LogicalType &type) {
+                return type.IsNumeric() || type.id() == LogicalTypeId::BOOLEAN;
+            });
+            options.value_input_option = raw ? "RAW" : "USER_ENTERED";
+        }
+        return std::move(bind_data);
     }
 
     unique_ptr<GlobalFunctionData> GSheetCopyFunction::GSheetWriteInitializeGlobal(ClientContext &context, FunctionData &bind_data, const string &file_path)
@@ -55,99 +619,238 @@ namespace duckdb
         }
 
         std::string token = token_value.ToString();
+        auto request_settings = GetRequestSettings(context);
         std::string spreadsheet_id = extract_spreadsheet_id(file_path);
         std::string sheet_id = extract_sheet_id(file_path);
-        std::string sheet_name = "Sheet1";
 
-        sheet_name = get_sheet_name_from_id(spreadsheet_id, sheet_id, token);
+        auto &options = bind_data.Cast<GSheetWriteBindData>().options;
+        auto &names = options.name_list;
 
-        std::string encoded_sheet_name = url_encode(sheet_name);
+        auto &metadata_cache = SpreadsheetMetadataCache::Get(context);
+        SheetProperties sheet;
+        if (options.sheet.empty())
+        {
+            sheet = metadata_cache.GetSheetById(context, spreadsheet_id, sheet_id, token);
+        }
+        else
+        {
+            // The sheet named by SHEET is added if the spreadsheet does not have it
+            auto sheets = metadata_cache.GetSheets(context, spreadsheet_id, token);
+            auto existing = std::find_if(sheets.begin(), sheets.end(), [&](const SheetProperties &properties) {
+                return properties.title == options.sheet;
+            });
+            if (existing != sheets.end())
+            {
+                sheet = *existing;
+            }
+            else
+            {
+                sheet = AddSheet(spreadsheet_id, token, request_settings, options.sheet, names.size());
+                metadata_cache.Invalidate(spreadsheet_id);
+            }
+        }
+        std::string sheet_name = sheet.title;
 
-        // If writing, clear out the entire sheet first.
-        // Do this here in the initialization so that it only happens once
-        std::string delete_response = delete_sheet_data(spreadsheet_id, token, encoded_sheet_name);
+        std::string encoded_sheet_name = url_encode(sheet_name);
 
-        // Write out the headers to the file here in the Initialize so they are only written once
-        // Create object ready to write to Google Sheet
-        json sheet_data;
+        auto gstate = make_uniq<GSheetCopyGlobalState>(context, spreadsheet_id, token, sheet_name, encoded_sheet_name);
 
-        sheet_data["range"] = sheet_name;
-        sheet_data["majorDimension"] = "ROWS";
-        
-        vector<string> headers = bind_data.Cast<GSheetWriteBindData>().options.name_list;        
+        // A merge keeps the rows of the sheet, new rows go below them
+        idx_t existing_rows = options.merge ? LoadExistingRows(*gstate, options) : 0;
 
-        vector<vector<string>> values;
-        values.push_back(headers);
-        sheet_data["values"] = values;
+        // An append keeps the rows of the sheet and checks its header, if it has one
+        bool has_header = false;
+        if (options.append)
+        {
+            HttpResponse header_response = batch_get_sheet_values(spreadsheet_id, token, request_settings, {url_encode(quote_sheet_name(sheet_name) + "!1:1")},
+                                                                  "&valueRenderOption=UNFORMATTED_VALUE");
+            if (!header_response.IsSuccess())
+            {
+                throw duckdb::IOException("Error reading Google Sheet to append to: " + get_response_error(header_response));
+            }
+            auto header = parseJson(header_response.body).value(json::json_pointer("/valueRanges/0/values/0"), json::array());
+            if (!header.empty())
+            {
+                CheckHeader(*gstate, names, header, "append to");
+                has_header = true;
+            }
+            gstate->append_at_end = true;
+        }
 
-        // Convert the JSON object to a string
-        std::string request_body = sheet_data.dump();
+        // Otherwise clear out the entire sheet first.
+        // Do this here in the initialization so that it only happens once
+        if (!options.merge && !options.append)
+        {
+            HttpResponse delete_response = delete_sheet_data(spreadsheet_id, token, request_settings, encoded_sheet_name);
+            if (!delete_response.IsSuccess()) {
+                throw duckdb::IOException("Error clearing Google Sheet: " + get_response_error(delete_response));
+            }
+        }
 
-        // Make the API call to write data to the Google Sheet
-        // Today, this is only append.
-        std::string response = call_sheets_api(spreadsheet_id, token, encoded_sheet_name, HttpMethod::POST, request_body);
+        gstate->sheet_id = sheet.sheet_id;
+        gstate->write_method = options.write_method;
+        gstate->value_input_option = options.value_input_option;
+        gstate->last_column = column_index_to_letter(names.size() - 1);
+        gstate->grid_rows = sheet.row_count;
+        gstate->initial_grid_rows = sheet.row_count;
+        gstate->grid_columns = sheet.column_count;
+
+        // Rows are written to explicit ranges, which must lie within the grid. Size it for the columns and the
+        // header in one request, later rows grow it as they are reserved.
+        if (gstate->grid_columns < names.size() || gstate->grid_rows == 0)
+        {
+            gstate->grid_rows = MaxValue<idx_t>(gstate->grid_rows, 1);
+            gstate->grid_columns = MaxValue<idx_t>(gstate->grid_columns, names.size());
+            CheckResize(ResizeGrid(*gstate, gstate->grid_rows, gstate->grid_columns));
+        }
 
-        // Check for errors in the response
-        json response_json = parseJson(response);
-        if (response_json.contains("error")) {
-            throw duckdb::IOException("Error writing to Google Sheet: " + response_json["error"]["message"].get<std::string>());
+        // Write out the headers to the file here in the Initialize so they are only written once. A merge into a
+        // sheet that has rows, and an append to a sheet that has a header, keep its header.
+        if (existing_rows > 0)
+        {
+            gstate->next_row = existing_rows + 1;
+        }
+        else if (!has_header)
+        {
+            GSheetRowBuffer header;
+            SheetRowEncoder::AppendHeader(names, GetRowFormat(options), header.values);
+            header.row_count = 1;
+            WriteRows(*gstate, header);
+            CompletePendingWrites(*gstate);
         }
 
-        return make_uniq<GSheetCopyGlobalState>(context, spreadsheet_id, token, encoded_sheet_name);
+        // The write changes the grid of the sheet, so later reads must fetch its properties again
+        metadata_cache.Invalidate(spreadsheet_id);
+
+        return std::move(gstate);
     }
 
     unique_ptr<LocalFunctionData> GSheetCopyFunction::GSheetWriteInitializeLocal(ExecutionContext &context, FunctionData &bind_data_p)
     {
-        return make_uniq<LocalFunctionData>();
+        auto &bind_data = bind_data_p.Cast<GSheetWriteBindData>();
+        return make_uniq<GSheetCopyLocalState>(bind_data.sql_types, GetRowFormat(bind_data.options), bind_data.options.merge);
     }
 
-    void GSheetCopyFunction::GSheetWriteSink(ExecutionContext &context, FunctionData &bind_data_p, GlobalFunctionData &gstate_p, LocalFunctionData &lstate, DataChunk &input)
+    void GSheetCopyFunction::GSheetWriteSink(ExecutionContext &context, FunctionData &bind_data_p, GlobalFunctionData &gstate_p, LocalFunctionData &lstate_p, DataChunk &input)
     {
-        input.Flatten();
         auto &gstate = gstate_p.Cast<GSheetCopyGlobalState>();
+        auto &lstate = lstate_p.Cast<GSheetCopyLocalState>();
+        auto &options = bind_data_p.Cast<GSheetWriteBindData>().options;
 
-        std::string sheet_id = extract_sheet_id(bind_data_p.Cast<GSheetWriteBindData>().files[0]);
-
-        std::string sheet_name = "Sheet1";
-
-        sheet_name = get_sheet_name_from_id(gstate.spreadsheet_id, sheet_id, gstate.token);
-        std::string encoded_sheet_name = url_encode(sheet_name);
-        // Create object ready to write to Google Sheet
-        json sheet_data;
+        idx_t scale = GetBatchScale(options, gstate);
+        lstate.encoder.SetChunk(input);
+        if (options.merge)
+        {
+            // The keys of the whole chunk are checked at once, before any of its rows is written
+            lstate.merge_cells.resize(input.size());
+            lstate.merge_keys.resize(input.size());
+            for (idx_t r = 0; r < input.size(); r++)
+            {
+                lstate.encoder.GetComparableRow(r, lstate.merge_cells[r]);
+                lstate.merge_keys[r] = RowKey(lstate.merge_cells[r], options.key_columns);
+            }
+            CheckUniqueKeys(gstate, options, lstate.merge_keys);
+        }
+        for (idx_t r = 0; r < input.size(); r++)
+        {
+            if (options.merge)
+            {
+                auto &cells = lstate.merge_cells[r];
+                auto existing = gstate.existing_rows.find(lstate.merge_keys[r]);
+                if (existing != gstate.existing_rows.end())
+                {
+                    // Rows with a known key are only written if they changed
+                    if (RowChanged(cells, existing->second))
+                    {
+                        string row;
+                        lstate.encoder.AppendRow(r, row);
+                        lstate.updates.Add(existing->second.row, std::move(row));
+                        if (UpdatesAreFull(options, lstate.updates, scale))
+                        {
+                            WriteUpdates(gstate, lstate.updates);
+                            lstate.updates.Clear();
+                        }
+                    }
+                    continue;
+                }
+            }
+            if (lstate.buffer.row_count > 0)
+            {
+                lstate.buffer.values += ',';
+            }
+            lstate.encoder.AppendRow(r, lstate.buffer.values);
+            lstate.buffer.row_count++;
 
-        sheet_data["range"] = sheet_name;
-        sheet_data["majorDimension"] = "ROWS";    
+            if (BufferIsFull(options, lstate.buffer, scale))
+            {
+                WriteRows(gstate, lstate.buffer);
+                lstate.buffer.Clear();
+            }
+        }
+    }
 
-        vector<vector<string>> values;
+    void GSheetCopyFunction::GSheetWriteCombine(ExecutionContext &context, FunctionData &bind_data_p, GlobalFunctionData &gstate_p, LocalFunctionData &lstate_p)
+    {
+        auto &gstate = gstate_p.Cast<GSheetCopyGlobalState>();
+        auto &lstate = lstate_p.Cast<GSheetCopyLocalState>();
+        auto &options = bind_data_p.Cast<GSheetWriteBindData>().options;
+        WriteUpdates(gstate, lstate.updates);
+        lstate.updates.Clear();
+        if (lstate.buffer.row_count == 0)
+        {
+            return;
+        }
 
-        for (idx_t r = 0; r < input.size(); r++)
+        idx_t scale = GetBatchScale(options, gstate);
+        GSheetRowBuffer full;
         {
-            vector<string> row;
-            for (idx_t c = 0; c < input.ColumnCount(); c++)
+            lock_guard<mutex> guard(gstate.lock);
+            if (gstate.remainder.row_count > 0)
             {
-                auto &col = input.data[c];
-                Value val = col.GetValue(r);
-                if (val.IsNull()) {
-                    row.push_back("");
-                } else {
-                    row.push_back(val.ToString());
-                }
+                gstate.remainder.values += ',';
+            }
+            gstate.remainder.values += lstate.buffer.values;
+            gstate.remainder.row_count += lstate.buffer.row_count;
+            lstate.buffer.Clear();
+            if (BufferIsFull(options, gstate.remainder, scale))
+            {
+                std::swap(full, gstate.remainder);
             }
-            values.push_back(row);
         }
-        sheet_data["values"] = values;
+        // Written outside of the lock, so other threads can reserve rows in the meantime
+        WriteRows(gstate, full);
+    }
 
-        // Convert the JSON object to a string
-        std::string request_body = sheet_data.dump();
+    CopyFunctionExecutionMode GSheetCopyFunction::GSheetWriteExecutionMode(bool preserve_insertion_order, bool supports_batch_index)
+    {
+        // Every batch of rows is written to rows reserved for it, so threads only need to be kept in order when
+        // the rows must be
+        if (!preserve_insertion_order)
+        {
+            return CopyFunctionExecutionMode::PARALLEL_COPY_TO_FILE;
+        }
+        return CopyFunctionExecutionMode::REGULAR_COPY_TO_FILE;
+    }
 
-        // Make the API call to write data to the Google Sheet
-        // Today, this is only append.
-        std::string response = call_sheets_api(gstate.spreadsheet_id, gstate.token, encoded_sheet_name, HttpMethod::POST, request_body);
+    void GSheetCopyFunction::GSheetWriteFinalize(ClientContext &context, FunctionData &bind_data_p, GlobalFunctionData &gstate_p)
+    {
+        auto &gstate = gstate_p.Cast<GSheetCopyGlobalState>();
+        WriteRows(gstate, gstate.remainder);
+        gstate.remainder.Clear();
+        CompletePendingWrites(gstate);
 
-        // Check for errors in the response
-        json response_json = parseJson(response);
-        if (response_json.contains("error")) {
-            throw duckdb::IOException("Error writing to Google Sheet: " + response_json["error"]["message"].get<std::string>());
+        // Trim the rows the grid grew ahead of the rows written
+        idx_t rows = MaxValue(gstate.initial_grid_rows, gstate.next_row - 1);
+        if (gstate.grid_rows > rows)
+        {
+            CheckResize(ResizeGrid(gstate, rows, gstate.grid_columns));
+            gstate.grid_rows = rows;
         }
+
+        // Drop the metadata cached while the copy ran, the sheet has grown since
+        SpreadsheetMetadataCache::Get(context).Invalidate(gstate.spreadsheet_id);
+        // Cached reads are stale too
+        SheetMemoryCache::Get(context).Invalidate(gstate.spreadsheet_id);
+        SheetDiskCache(context).Invalidate(gstate.spreadsheet_id);
     }
 } // namespace duckdb
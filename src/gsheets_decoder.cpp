@@ -0,0 +1,839 @@
+#include "gsheets_decoder.hpp"
+#include "gsheets_utils.hpp"
+#include "duckdb/common/exception.hpp"
+#include "duckdb/common/operator/cast_operators.hpp"
+#include "duckdb/common/vector_operations/vector_operations.hpp"
+#include "duckdb/common/types/date.hpp"
+#include "duckdb/common/types/timestamp.hpp"
+#include <json.hpp>
+
+#include <cmath>
+
+namespace duckdb {
+
+using json = nlohmann::json;
+
+//! SAX handler for the {range, majorDimension, values: [[...]]} shape of a values response, and the
+//! {spreadsheetId, valueRanges: [{range, majorDimension, values: [[...]]}, ...]} shape of a values:batchGet response.
+//! Cells are handed to the SINK as they are read, so neither a DOM nor per-row copies are built. The range of each
+//! values array is handed to the SINK before its rows, the API returns it first.
+template <class SINK>
+class SheetValuesHandler : public nlohmann::json_sax<json> {
+public:
+    explicit SheetValuesHandler(SINK &sink) : sink(sink) {
+    }
+
+    bool null() override {
+        if (InRow()) {
+            sink.Null(col);
+            col++;
+        }
+        return true;
+    }
+
+    bool boolean(bool val) override {
+        if (InRow()) {
+            sink.Boolean(col, val);
+            col++;
+        }
+        return true;
+    }
+
+    bool number_integer(number_integer_t val) override {
+        if (InError()) {
+            if (error_key == "code") {
+                error_code = val;
+            }
+            return true;
+        }
+        if (InRow()) {
+            sink.Integer(col, val);
+            col++;
+        }
+        return true;
+    }
+
+    bool number_unsigned(number_unsigned_t val) override {
+        if (InError()) {
+            if (error_key == "code") {
+                error_code = static_cast<int64_t>(val);
+            }
+            return true;
+        }
+        if (InRow()) {
+            if (val <= static_cast<number_unsigned_t>(NumericLimits<int64_t>::Maximum())) {
+                sink.Integer(col, static_cast<int64_t>(val));
+            } else {
+                auto str = std::to_string(val);
+                sink.Number(col, static_cast<double>(val), str.c_str(), str.size());
+            }
+            col++;
+        }
+        return true;
+    }
+
+    bool number_float(number_float_t val, const string_t &s) override {
+        if (InRow()) {
+            sink.Number(col, val, s.c_str(), s.size());
+            col++;
+        }
+        return true;
+    }
+
+    bool string(string_t &val) override {
+        if (InError()) {
+            if (error_key == "message") {
+                error_message = val;
+            }
+            return true;
+        }
+        if (depth == 1 && top_key == "range") {
+            sink.RangeStart(0, val.c_str(), val.size());
+            return true;
+        }
+        if (ranges_depth != 0 && depth == ranges_depth + 1 && range_key == "range") {
+            sink.RangeStart(range_count - 1, val.c_str(), val.size());
+            return true;
+        }
+        return Scalar(val.c_str(), val.size());
+    }
+
+    bool binary(binary_t &val) override {
+        return true;
+    }
+
+    bool start_object(std::size_t elements) override {
+        depth++;
+        if (depth == 2 && top_key == "error") {
+            has_error = true;
+        } else if (ranges_depth != 0 && depth == ranges_depth + 1) {
+            range_count++;
+            range_key.clear();
+        }
+        return true;
+    }
+
+    bool key(string_t &val) override {
+        if (depth == 1) {
+            top_key = val;
+        } else if (depth == 2 && has_error) {
+            error_key = val;
+        } else if (ranges_depth != 0 && depth == ranges_depth + 1) {
+            range_key = val;
+        }
+        return true;
+    }
+
+    bool end_object() override {
+        depth--;
+        return true;
+    }
+
+    bool start_array(std::size_t elements) override {
+        depth++;
+        if (values_depth != 0) {
+            if (depth == values_depth + 1) {
+                col = 0;
+                sink.BeginRow();
+            }
+        } else if (depth == 2 && top_key == "values") {
+            BeginRange(0);
+        } else if (depth == 2 && top_key == "valueRanges") {
+            ranges_depth = depth;
+        } else if (ranges_depth != 0 && depth == ranges_depth + 2 && range_key == "values") {
+            BeginRange(range_count - 1);
+        }
+        return true;
+    }
+
+    bool end_array() override {
+        if (values_depth != 0 && depth == values_depth + 1) {
+            range_rows++;
+            row_count = MaxValue<idx_t>(row_count, range_rows);
+            if (!sink.EndRow(col)) {
+                stopped = true;
+                return false;
+            }
+        } else if (depth == values_depth) {
+            values_depth = 0;
+        } else if (depth == ranges_depth) {
+            ranges_depth = 0;
+        }
+        depth--;
+        return true;
+    }
+
+    bool parse_error(std::size_t position, const std::string &last_token, const nlohmann::detail::exception &ex) override {
+        parse_error_message = ex.what();
+        return false;
+    }
+
+    //! Throws if the response was an API error or could not be parsed
+    void Verify(bool parsed) const {
+        if (has_error) {
+            throw IOException("Google Sheets API error: %d - %s", error_code, error_message);
+        }
+        if (!parsed && !stopped) {
+            throw IOException("Failed to parse Google Sheets response: %s", parse_error_message);
+        }
+    }
+
+    //! The number of rows in the longest range
+    idx_t row_count = 0;
+
+private:
+    void BeginRange(idx_t range_index) {
+        values_depth = depth;
+        range_rows = 0;
+        sink.BeginRange(range_index);
+    }
+
+    bool InRow() const {
+        return values_depth != 0 && depth == values_depth + 1;
+    }
+
+    bool InError() const {
+        return has_error && depth == 2;
+    }
+
+    bool Scalar(const char *data, idx_t len) {
+        if (InRow()) {
+            sink.Cell(col, data, len);
+            col++;
+        }
+        return true;
+    }
+
+    SINK &sink;
+    //! Current object/array nesting depth
+    idx_t depth = 0;
+    //! Depth of the values array being read, or 0 when outside of it
+    idx_t values_depth = 0;
+    //! Depth of the valueRanges array, or 0 when outside of it
+    idx_t ranges_depth = 0;
+    //! Number of valueRanges objects started so far
+    idx_t range_count = 0;
+    //! Number of rows read from the current values array
+    idx_t range_rows = 0;
+    //! Index of the next cell in the current row
+    idx_t col = 0;
+    //! Last key read in the top level object
+    std::string top_key;
+    //! Last key read in the current valueRanges object
+    std::string range_key;
+    std::string error_key;
+    bool has_error = false;
+    int64_t error_code = 0;
+    std::string error_message;
+    //! Whether the sink asked to stop parsing
+    bool stopped = false;
+    std::string parse_error_message;
+};
+
+//! Serial numbers beyond this many days are out of the range of dates
+static constexpr double MAX_SERIAL_DAYS = 100000000;
+
+bool SheetSerialToDate(double serial, date_t &result) {
+    if (!(std::fabs(serial) < MAX_SERIAL_DAYS)) {
+        return false;
+    }
+    result = date_t(static_cast<int32_t>(static_cast<int64_t>(std::floor(serial)) - SERIAL_EPOCH_DAYS));
+    return Date::IsFinite(result);
+}
+
+bool SheetSerialToTimestamp(double serial, timestamp_t &result) {
+    if (!(std::fabs(serial) < MAX_SERIAL_DAYS)) {
+        return false;
+    }
+    // Round to the microsecond, serial times are fractions of a day and rarely exact
+    auto micros = std::llround((serial - SERIAL_EPOCH_DAYS) * static_cast<double>(Interval::MICROS_PER_DAY));
+    result = timestamp_t(micros);
+    return Timestamp::IsFinite(result);
+}
+
+//! The rows between the sheet row a range was requested from and the first row of its values, which the response
+//! names in its range, e.g. 'Sheet1'!A5:C10. 0 if the response range cannot be read.
+static idx_t GetRangeOffset(const SheetColumnMapping &mapping, idx_t range_index, const char *data, idx_t len) {
+    if (range_index >= mapping.range_first_rows.size()) {
+        return 0;
+    }
+    SheetRange range;
+    try {
+        range = parse_sheet_range(string(data, len));
+    } catch (std::exception &) {
+        return 0;
+    }
+    idx_t requested_row = mapping.range_first_rows[range_index];
+    return range.first_row > requested_row ? range.first_row - requested_row : 0;
+}
+
+//! Parses a cell into a row of a staging vector, returns false if it does not parse as the vector type
+typedef bool (*cell_parser_t)(Vector &vector, idx_t row, const char *data, idx_t len);
+
+template <class T>
+static bool ParseCell(Vector &vector, idx_t row, const char *data, idx_t len) {
+    // Numbers are parsed with fast_float, dates and timestamps with the DuckDB parsers
+    return TryCast::Operation<string_t, T>(string_t(data, static_cast<uint32_t>(len)),
+                                           FlatVector::GetData<T>(vector)[row], false);
+}
+
+static bool ParseVarcharCell(Vector &vector, idx_t row, const char *data, idx_t len) {
+    FlatVector::GetData<string_t>(vector)[row] = StringVector::AddString(vector, data, len);
+    return true;
+}
+
+//! The parser decoding cells straight into a vector of the type, or nullptr if cells of that type are staged as
+//! strings and cast once the response is read
+static cell_parser_t GetCellParser(const LogicalType &type) {
+    switch (type.id()) {
+    case LogicalTypeId::VARCHAR:
+        return ParseVarcharCell;
+    case LogicalTypeId::BOOLEAN:
+        return ParseCell<bool>;
+    case LogicalTypeId::BIGINT:
+        return ParseCell<int64_t>;
+    case LogicalTypeId::DOUBLE:
+        return ParseCell<double>;
+    case LogicalTypeId::DATE:
+        return ParseCell<date_t>;
+    case LogicalTypeId::TIMESTAMP:
+        return ParseCell<timestamp_t>;
+    default:
+        return nullptr;
+    }
+}
+
+//! Writes the decoded cells of a response into staging vectors, one per output column. Cells of the common types
+//! are parsed straight into vectors of the output type, cells of other types are staged as strings. Every range of a
+//! part fills its own output columns at the rows of its sheet rows, and the rows of the parts are stacked, so the
+//! rows are only appended to the collection once all ranges are read.
+class SheetVectorSink {
+public:
+    SheetVectorSink(ClientContext &context, const SheetColumnMapping &mapping, ColumnDataCollection &collection)
+        : mapping(mapping), collection(collection), capacity(STANDARD_VECTOR_SIZE) {
+        for (auto &type : collection.Types()) {
+            auto parser = GetCellParser(type);
+            parsers.push_back(parser ? parser : ParseVarcharCell);
+            staging.emplace_back(parser ? type : LogicalType::VARCHAR, capacity);
+        }
+        range_rows.resize(mapping.range_columns.size(), 0);
+        range_offsets.resize(mapping.range_columns.size(), 0);
+        typed.Initialize(context, collection.Types());
+    }
+
+    void RangeStart(idx_t range_index, const char *data, idx_t len) {
+        if (range_index < range_offsets.size()) {
+            range_offsets[range_index] = GetRangeOffset(mapping, range_index, data, len);
+        }
+    }
+
+    void BeginRange(idx_t range_index) {
+        if (range_index >= range_rows.size()) {
+            throw IOException("Google Sheets response has more ranges than were requested");
+        }
+        idx_t range_part = RangePart(range_index);
+        if (range_part != part) {
+            // Ranges come back in the order they were requested, the rows of the previous parts are complete
+            AdvanceTo(range_part);
+        }
+        range = range_index;
+        row = part_start + leading_rows + range_offsets[range_index];
+    }
+
+    void BeginRow() {
+        while (row >= capacity) {
+            Grow();
+        }
+    }
+
+    void Cell(idx_t col, const char *data, idx_t len) {
+        idx_t output_col = OutputColumn(col);
+        if (output_col == DConstants::INVALID_INDEX) {
+            return;
+        }
+        auto &vec = staging[output_col];
+        // Empty cells are NULL, except in string columns
+        bool is_string = vec.GetType().id() == LogicalTypeId::VARCHAR;
+        if (len == 0 && !is_string) {
+            FlatVector::SetNull(vec, row, true);
+        } else if (!parsers[output_col](vec, row, data, len)) {
+            ThrowConversionError(range, col, RangeRow(), string(data, len), vec.GetType());
+        }
+    }
+
+    void Integer(idx_t col, int64_t value) {
+        idx_t output_col = OutputColumn(col);
+        if (output_col == DConstants::INVALID_INDEX) {
+            return;
+        }
+        auto &vec = staging[output_col];
+        if (vec.GetType().id() == LogicalTypeId::BIGINT) {
+            FlatVector::GetData<int64_t>(vec)[row] = value;
+            return;
+        }
+        auto str = std::to_string(value);
+        StoreNumber(col, output_col, static_cast<double>(value), str.c_str(), str.size());
+    }
+
+    void Number(idx_t col, double value, const char *data, idx_t len) {
+        idx_t output_col = OutputColumn(col);
+        if (output_col != DConstants::INVALID_INDEX) {
+            StoreNumber(col, output_col, value, data, len);
+        }
+    }
+
+    void Boolean(idx_t col, bool value) {
+        idx_t output_col = OutputColumn(col);
+        if (output_col == DConstants::INVALID_INDEX) {
+            return;
+        }
+        auto &vec = staging[output_col];
+        if (vec.GetType().id() == LogicalTypeId::BOOLEAN) {
+            FlatVector::GetData<bool>(vec)[row] = value;
+        } else if (!parsers[output_col](vec, row, value ? "TRUE" : "FALSE", value ? 4 : 5)) {
+            ThrowConversionError(range, col, RangeRow(), value ? "TRUE" : "FALSE", vec.GetType());
+        }
+    }
+
+    void Null(idx_t col) {
+        idx_t output_col = OutputColumn(col);
+        if (output_col != DConstants::INVALID_INDEX) {
+            FlatVector::SetNull(staging[output_col], row, true);
+        }
+    }
+
+    bool EndRow(idx_t width) {
+        // Trailing empty cells are omitted from the response
+        for (idx_t col = width; col < mapping.range_widths[range]; col++) {
+            Null(col);
+        }
+        row++;
+        range_rows[range] = RangeRow();
+        return true;
+    }
+
+    //! Appends the rows to the collection, returns the number of rows and the number of rows holding values of each
+    //! part
+    idx_t Finalize(vector<idx_t> *part_rows) {
+        idx_t part_count = mapping.part_trailing_rows.size();
+        if (!mapping.range_columns.empty()) {
+            part_count = MaxValue<idx_t>(part_count, RangePart(mapping.range_columns.size() - 1) + 1);
+        }
+        AdvanceTo(part_count);
+        idx_t row_count = part_start;
+        if (part_rows) {
+            *part_rows = std::move(closed_part_extents);
+        }
+
+        auto &types = collection.Types();
+        for (idx_t offset = 0; offset < row_count; offset += STANDARD_VECTOR_SIZE) {
+            idx_t count = MinValue<idx_t>(STANDARD_VECTOR_SIZE, row_count - offset);
+            typed.Reset();
+            for (idx_t col = 0; col < types.size(); col++) {
+                Vector slice(staging[col], offset, offset + count);
+                if (staging[col].GetType() == types[col]) {
+                    typed.data[col].Reference(slice);
+                } else {
+                    string error_message;
+                    if (!VectorOperations::DefaultTryCast(slice, typed.data[col], count, &error_message)) {
+                        ThrowCastError(col, offset, count, typed.data[col]);
+                    }
+                }
+            }
+            typed.SetCardinality(count);
+            collection.Append(typed);
+        }
+        return row_count;
+    }
+
+private:
+    idx_t RangePart(idx_t range_index) const {
+        return mapping.range_parts.empty() ? 0 : mapping.range_parts[range_index];
+    }
+
+    //! The row of the current range, relative to the sheet row it was requested from
+    idx_t RangeRow() const {
+        return row - part_start - leading_rows;
+    }
+
+    //! Closes the current part and the parts without ranges up to next_part, which only hold their trailing rows, and
+    //! starts next_part below their rows
+    void AdvanceTo(idx_t next_part) {
+        idx_t skipped_part = part == DConstants::INVALID_INDEX ? 0 : part + 1;
+        ClosePart();
+        for (; skipped_part < next_part; skipped_part++) {
+            part = skipped_part;
+            leading_rows = 0;
+            ClosePart();
+        }
+        part = next_part;
+        leading_rows = next_part < mapping.part_leading_rows.size() ? mapping.part_leading_rows[next_part] : 0;
+    }
+
+    //! Pads the ranges of the current part to its longest one, adds its leading and trailing rows, fills in the values
+    //! of the part, and starts the next part below its rows
+    void ClosePart() {
+        if (part == DConstants::INVALID_INDEX) {
+            return;
+        }
+        idx_t data_rows = 0;
+        for (idx_t r = 0; r < range_rows.size(); r++) {
+            if (RangePart(r) == part) {
+                data_rows = MaxValue<idx_t>(data_rows, range_rows[r]);
+            }
+        }
+        // Leading rows are only added above rows holding values, a part without any is empty
+        idx_t leading = data_rows > 0 ? leading_rows : 0;
+        idx_t trailing = part < mapping.part_trailing_rows.size() ? mapping.part_trailing_rows[part] : 0;
+        idx_t part_end = part_start + leading + data_rows + trailing;
+        while (part_end > capacity) {
+            Grow();
+        }
+        // Cells outside of the rows read from their range, or without a sheet column, are NULL
+        vector<idx_t> filled_begin(staging.size(), part_start);
+        vector<idx_t> filled_end(staging.size(), part_start);
+        for (idx_t r = 0; r < range_rows.size(); r++) {
+            if (RangePart(r) != part || range_rows[r] == 0) {
+                continue;
+            }
+            for (idx_t col = 0; col < mapping.range_widths[r]; col++) {
+                idx_t output_col = mapping.output_columns[mapping.range_columns[r] + col];
+                if (output_col != DConstants::INVALID_INDEX) {
+                    filled_begin[output_col] = part_start + leading + range_offsets[r];
+                    filled_end[output_col] = part_start + leading + range_rows[r];
+                }
+            }
+        }
+        for (idx_t i = 0; i < mapping.constant_columns.size(); i++) {
+            auto &vec = staging[mapping.constant_columns[i]];
+            auto &value = mapping.part_constants[part][i];
+            auto str = StringVector::AddString(vec, value);
+            auto data = FlatVector::GetData<string_t>(vec);
+            for (idx_t r = part_start; r < part_end; r++) {
+                data[r] = str;
+            }
+            filled_end[mapping.constant_columns[i]] = part_end;
+        }
+        for (idx_t col = 0; col < staging.size(); col++) {
+            for (idx_t r = part_start; r < part_end; r++) {
+                if (r < filled_begin[col] || r >= filled_end[col]) {
+                    FlatVector::SetNull(staging[col], r, true);
+                }
+            }
+        }
+        closed_part_rows.resize(part + 1, 0);
+        closed_part_rows[part] = part_end - part_start;
+        closed_part_starts.resize(part + 1, 0);
+        closed_part_starts[part] = part_start;
+        closed_part_leading_rows.resize(part + 1, 0);
+        closed_part_leading_rows[part] = leading;
+        closed_part_extents.resize(part + 1, 0);
+        closed_part_extents[part] = data_rows;
+        part_start = part_end;
+    }
+
+    //! Stores a JSON number of an unformatted response, dates and timestamps are serial numbers
+    void StoreNumber(idx_t col, idx_t output_col, double value, const char *data, idx_t len) {
+        auto &vec = staging[output_col];
+        bool valid;
+        switch (vec.GetType().id()) {
+        case LogicalTypeId::DOUBLE:
+            FlatVector::GetData<double>(vec)[row] = value;
+            return;
+        case LogicalTypeId::BIGINT:
+            valid = TryCast::Operation<double, int64_t>(value, FlatVector::GetData<int64_t>(vec)[row], false);
+            break;
+        case LogicalTypeId::DATE:
+            valid = SheetSerialToDate(value, FlatVector::GetData<date_t>(vec)[row]);
+            break;
+        case LogicalTypeId::TIMESTAMP:
+            valid = SheetSerialToTimestamp(value, FlatVector::GetData<timestamp_t>(vec)[row]);
+            break;
+        default:
+            valid = parsers[output_col](vec, row, data, len);
+            break;
+        }
+        if (!valid) {
+            ThrowConversionError(range, col, RangeRow(), string(data, len), vec.GetType());
+        }
+    }
+
+    //! Throws for a cell that does not convert to the type of its column, naming the cell if the mapping says where
+    //! the range was read from
+    [[noreturn]] void ThrowConversionError(idx_t range_index, idx_t range_col, idx_t range_row, const string &value,
+                                           const LogicalType &type) const {
+        string cell = "a cell";
+        if (range_index < mapping.range_first_rows.size() && range_index < mapping.range_first_columns.size()) {
+            cell = "cell " + column_index_to_letter(mapping.range_first_columns[range_index] + range_col) +
+                   std::to_string(mapping.range_first_rows[range_index] + range_row);
+            idx_t range_part = RangePart(range_index);
+            if (range_part < mapping.part_sheets.size()) {
+                cell += " of sheet '" + mapping.part_sheets[range_part] + "'";
+            }
+        }
+        throw ConversionException("Could not convert %s with value \"%s\" to %s, give the column types with the "
+                                  "columns parameter or sample more rows with sample_size",
+                                  cell, value, type.ToString());
+    }
+
+    //! Throws for the first row of [offset, offset + count) of a column staged as strings that did not cast
+    [[noreturn]] void ThrowCastError(idx_t output_col, idx_t offset, idx_t count, const Vector &result) const {
+        auto &strings = staging[output_col];
+        for (idx_t i = 0; i < count; i++) {
+            idx_t staging_row = offset + i;
+            if (FlatVector::IsNull(strings, staging_row) || !FlatVector::IsNull(result, i)) {
+                continue;
+            }
+            auto value = FlatVector::GetData<string_t>(strings)[staging_row].GetString();
+            // Find the part the row belongs to, and the range of the part holding the column
+            for (idx_t p = 0; p < closed_part_starts.size(); p++) {
+                idx_t start = closed_part_starts[p];
+                if (staging_row < start || staging_row >= start + closed_part_rows[p]) {
+                    continue;
+                }
+                for (idx_t r = 0; r < mapping.range_columns.size(); r++) {
+                    if (RangePart(r) != p) {
+                        continue;
+                    }
+                    for (idx_t col = 0; col < mapping.range_widths[r]; col++) {
+                        if (mapping.output_columns[mapping.range_columns[r] + col] == output_col) {
+                            ThrowConversionError(r, col, staging_row - start - closed_part_leading_rows[p], value,
+                                                 result.GetType());
+                        }
+                    }
+                }
+            }
+            ThrowConversionError(DConstants::INVALID_INDEX, 0, 0, value, result.GetType());
+        }
+        throw ConversionException("Could not convert a cell to %s", result.GetType().ToString());
+    }
+
+    idx_t OutputColumn(idx_t col) const {
+        if (col >= mapping.range_widths[range]) {
+            return DConstants::INVALID_INDEX;
+        }
+        return mapping.output_columns[mapping.range_columns[range] + col];
+    }
+
+    void Grow() {
+        for (auto &vec : staging) {
+            vec.Resize(capacity, capacity * 2);
+        }
+        capacity *= 2;
+    }
+
+    const SheetColumnMapping &mapping;
+    ColumnDataCollection &collection;
+    vector<Vector> staging;
+    vector<cell_parser_t> parsers;
+    idx_t capacity;
+    //! For each range, the rows from the sheet row it was requested from to the last row read, and the rows above
+    //! its first row of values
+    vector<idx_t> range_rows;
+    vector<idx_t> range_offsets;
+    idx_t range = 0;
+    idx_t row = 0;
+    //! The part being read, the first row of its rows, and the NULL rows above its first sheet row
+    idx_t part = DConstants::INVALID_INDEX;
+    idx_t part_start = 0;
+    idx_t leading_rows = 0;
+    //! The number of rows of each part read so far, the first of their rows, their leading NULL rows, and the rows
+    //! from the first sheet row of the part to its last row holding values
+    vector<idx_t> closed_part_rows;
+    vector<idx_t> closed_part_starts;
+    vector<idx_t> closed_part_leading_rows;
+    vector<idx_t> closed_part_extents;
+    DataChunk typed;
+};
+
+//! Counts the rows of each range, to tell how far the rows holding values of each part reach without decoding them
+class SheetExtentSink {
+public:
+    explicit SheetExtentSink(const SheetColumnMapping &mapping)
+        : mapping(mapping), range_rows(mapping.range_columns.size(), 0), range_offsets(mapping.range_columns.size(), 0) {
+    }
+
+    void RangeStart(idx_t range_index, const char *data, idx_t len) {
+        if (range_index < range_offsets.size()) {
+            range_offsets[range_index] = GetRangeOffset(mapping, range_index, data, len);
+        }
+    }
+
+    void BeginRange(idx_t range_index) {
+        if (range_index >= range_rows.size()) {
+            throw IOException("Google Sheets response has more ranges than were requested");
+        }
+        range = range_index;
+    }
+
+    void BeginRow() {
+    }
+
+    void Cell(idx_t col, const char *data, idx_t len) {
+    }
+
+    void Integer(idx_t col, int64_t value) {
+    }
+
+    void Number(idx_t col, double value, const char *data, idx_t len) {
+    }
+
+    void Boolean(idx_t col, bool value) {
+    }
+
+    void Null(idx_t col) {
+    }
+
+    bool EndRow(idx_t width) {
+        range_rows[range]++;
+        return true;
+    }
+
+    //! For each part, the rows from its first sheet row to its last row holding values
+    vector<idx_t> GetExtents() const {
+        vector<idx_t> extents;
+        for (idx_t r = 0; r < range_rows.size(); r++) {
+            idx_t range_part = mapping.range_parts.empty() ? 0 : mapping.range_parts[r];
+            if (extents.size() <= range_part) {
+                extents.resize(range_part + 1, 0);
+            }
+            if (range_rows[r] > 0) {
+                extents[range_part] = MaxValue<idx_t>(extents[range_part], range_offsets[r] + range_rows[r]);
+            }
+        }
+        return extents;
+    }
+
+private:
+    const SheetColumnMapping &mapping;
+    vector<idx_t> range_rows;
+    vector<idx_t> range_offsets;
+    idx_t range = 0;
+};
+
+//! Collects decoded cells as rows of strings, stopping after max_rows rows
+class SheetRowsSink {
+public:
+    explicit SheetRowsSink(idx_t max_rows) : max_rows(max_rows) {
+    }
+
+    void RangeStart(idx_t range_index, const char *data, idx_t len) {
+    }
+
+    void BeginRange(idx_t range_index) {
+    }
+
+    void BeginRow() {
+    }
+
+    void Cell(idx_t col, const char *data, idx_t len) {
+        current.resize(col + 1);
+        current[col].assign(data, len);
+    }
+
+    void Integer(idx_t col, int64_t value) {
+        auto str = std::to_string(value);
+        Cell(col, str.c_str(), str.size());
+    }
+
+    void Number(idx_t col, double value, const char *data, idx_t len) {
+        Cell(col, data, len);
+    }
+
+    void Boolean(idx_t col, bool value) {
+        Cell(col, value ? "TRUE" : "FALSE", value ? 4 : 5);
+    }
+
+    void Null(idx_t col) {
+        current.resize(col + 1);
+    }
+
+    bool EndRow(idx_t width) {
+        current.resize(width);
+        rows.push_back(std::move(current));
+        current.clear();
+        return rows.size() < max_rows;
+    }
+
+    vector<vector<string>> rows;
+
+private:
+    idx_t max_rows;
+    vector<string> current;
+};
+
+//! Collects the decoded cells of each range as rows of strings
+class SheetRangesSink : public SheetRowsSink {
+public:
+    explicit SheetRangesSink(idx_t range_count) : SheetRowsSink(DConstants::INVALID_INDEX), ranges(range_count) {
+    }
+
+    void BeginRange(idx_t range_index) {
+        if (range_index >= ranges.size()) {
+            throw IOException("Google Sheets response has more ranges than were requested");
+        }
+        Flush();
+        range = range_index;
+    }
+
+    //! Moves the rows read into the range they were read from
+    void Flush() {
+        for (auto &row : rows) {
+            ranges[range].push_back(std::move(row));
+        }
+        rows.clear();
+    }
+
+    vector<vector<vector<string>>> ranges;
+
+private:
+    idx_t range = 0;
+};
+
+template <class SINK>
+static idx_t ParseSheetValues(const string &response, SheetValuesHandler<SINK> &handler) {
+    // The body may be surrounded by transport noise, only parse the outermost object
+    size_t start = response.find('{');
+    size_t end = response.rfind('}');
+    if (start == string::npos || end == string::npos || end < start) {
+        throw IOException("No JSON object found in the Google Sheets response");
+    }
+    bool parsed = json::sax_parse(response.begin() + start, response.begin() + end + 1, &handler);
+    handler.Verify(parsed);
+    return handler.row_count;
+}
+
+idx_t DecodeSheetValues(ClientContext &context, const string &response, const SheetColumnMapping &mapping,
+                        ColumnDataCollection &collection, vector<idx_t> *part_rows) {
+    SheetVectorSink sink(context, mapping, collection);
+    SheetValuesHandler<SheetVectorSink> handler(sink);
+    ParseSheetValues(response, handler);
+    return sink.Finalize(part_rows);
+}
+
+vector<idx_t> DecodeSheetExtents(const string &response, const SheetColumnMapping &mapping) {
+    SheetExtentSink sink(mapping);
+    SheetValuesHandler<SheetExtentSink> handler(sink);
+    ParseSheetValues(response, handler);
+    return sink.GetExtents();
+}
+
+vector<vector<vector<string>>> DecodeSheetRanges(const string &response, idx_t range_count) {
+    SheetRangesSink sink(range_count);
+    SheetValuesHandler<SheetRangesSink> handler(sink);
+    ParseSheetValues(response, handler);
+    sink.Flush();
+    return std::move(sink.ranges);
+}
+
+vector<vector<string>> DecodeSheetRows(const string &response, idx_t max_rows) {
+    SheetRowsSink sink(max_rows);
+    if (max_rows == 0) {
+        return std::move(sink.rows);
+    }
+    SheetValuesHandler<SheetRowsSink> handler(sink);
+    ParseSheetValues(response, handler);
+    return std::move(sink.rows);
+}
+
+} // namespace duckdb
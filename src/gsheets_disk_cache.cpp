@@ -0,0 +1,170 @@
+#include "gsheets_disk_cache.hpp"
+#include "gsheets_utils.hpp"
+#include "duckdb/common/file_system.hpp"
+#include "duckdb/common/serializer/binary_deserializer.hpp"
+#include "duckdb/common/serializer/binary_serializer.hpp"
+#include "duckdb/common/serializer/buffered_file_reader.hpp"
+#include "duckdb/common/serializer/buffered_file_writer.hpp"
+#include "duckdb/common/types/hash.hpp"
+#include "duckdb/common/types/uuid.hpp"
+
+#include <chrono>
+
+namespace duckdb {
+
+//! Identifies the layout of cache files, entries of another layout are misses
+static constexpr const char *CACHE_FORMAT = "gsheets-cache-2";
+
+static int64_t CurrentTime() {
+    auto now = std::chrono::system_clock::now().time_since_epoch();
+    return std::chrono::duration_cast<std::chrono::seconds>(now).count();
+}
+
+const string &SpreadsheetVersion::Get() {
+    if (!fetched) {
+        // Tokens without Drive access, and failed requests, leave the read without a version, it can only expire
+        try {
+            version = get_spreadsheet_version(spreadsheet_id, token, settings);
+        } catch (std::exception &) {
+            version.clear();
+        }
+        fetched = true;
+    }
+    return version;
+}
+
+int64_t GetSheetCacheTTL(ClientContext &context) {
+    Value value;
+    if (context.TryGetCurrentSetting(SheetDiskCache::TTL_SETTING, value) && !value.IsNull()) {
+        return MaxValue<int64_t>(value.GetValue<int64_t>(), 0);
+    }
+    return SheetDiskCache::DEFAULT_TTL_SECONDS;
+}
+
+bool IsCachedSheetFresh(const CachedSheet &sheet, int64_t ttl, SpreadsheetVersion &version) {
+    if (CurrentTime() - sheet.read_at < ttl) {
+        return true;
+    }
+    // Reads without a version can only expire
+    return !sheet.version.empty() && version.Get() == sheet.version;
+}
+
+static void RemoveFileIfExists(FileSystem &fs, const string &path) {
+    try {
+        if (fs.FileExists(path)) {
+            fs.RemoveFile(path);
+        }
+    } catch (std::exception &) {
+    }
+}
+
+SheetDiskCache::SheetDiskCache(ClientContext &context) : context(context), ttl(GetSheetCacheTTL(context)) {
+    Value value;
+    if (context.TryGetCurrentSetting(DIRECTORY_SETTING, value) && !value.IsNull()) {
+        directory = value.ToString();
+    }
+}
+
+string SheetDiskCache::GetPath(const string &spreadsheet_id, const string &key) const {
+    auto &fs = FileSystem::GetFileSystem(context);
+    return fs.JoinPath(directory, spreadsheet_id + "-" + std::to_string(Hash(key.c_str(), key.size())) + ".gsheet");
+}
+
+shared_ptr<CachedSheet> SheetDiskCache::Load(const string &path, const string &key, SpreadsheetVersion &version) const {
+    auto &fs = FileSystem::GetFileSystem(context);
+    if (fs.FileExists(path)) {
+        try {
+            BufferedFileReader reader(fs, path.c_str());
+            BinaryDeserializer deserializer(reader);
+            deserializer.Begin();
+            // The file name only holds a hash of the key, an entry of another read with the same hash is a miss
+            if (deserializer.ReadProperty<string>(100, "format") == CACHE_FORMAT &&
+                deserializer.ReadProperty<string>(101, "key") == key) {
+                auto result = make_shared_ptr<CachedSheet>();
+                result->version = deserializer.ReadProperty<string>(102, "version");
+                result->read_at = deserializer.ReadProperty<int64_t>(103, "read_at");
+                result->names = deserializer.ReadProperty<vector<string>>(104, "names");
+                result->types = deserializer.ReadProperty<vector<LogicalType>>(105, "types");
+
+                // Only the header is read to tell whether the entry is fresh
+                if (IsCachedSheetFresh(*result, ttl, version)) {
+                    result->rows = make_shared_ptr<ColumnDataCollection>(context, result->types);
+                    deserializer.ReadList(106, "chunks", [&](Deserializer::List &list, idx_t i) {
+                        DataChunk chunk;
+                        list.ReadObject([&](Deserializer &object) { chunk.Deserialize(object); });
+                        result->rows->Append(chunk);
+                    });
+                    deserializer.End();
+                    return result;
+                }
+            }
+        } catch (std::exception &) {
+            // An unreadable entry is a miss, and is overwritten by the read
+        }
+    }
+    return nullptr;
+}
+
+void SheetDiskCache::Store(const string &path, const string &key, const CachedSheet &sheet) const {
+    auto &fs = FileSystem::GetFileSystem(context);
+    // Written to a temporary file that is moved in place, so that concurrent reads never see a partial entry
+    auto temp_path = path + "." + UUID::ToString(UUID::GenerateRandomUUID()) + ".tmp";
+    try {
+        if (!fs.DirectoryExists(directory)) {
+            fs.CreateDirectory(directory);
+        }
+        {
+            BufferedFileWriter writer(fs, temp_path);
+            BinarySerializer serializer(writer);
+            serializer.Begin();
+            serializer.WriteProperty(100, "format", string(CACHE_FORMAT));
+            serializer.WriteProperty(101, "key", key);
+            serializer.WriteProperty(102, "version", sheet.version);
+            serializer.WriteProperty(103, "read_at", sheet.read_at);
+            serializer.WriteProperty(104, "names", sheet.names);
+            serializer.WriteProperty(105, "types", sheet.types);
+            auto &rows = *sheet.rows;
+            serializer.WriteList(106, "chunks", rows.ChunkCount(), [&](Serializer::List &list, idx_t i) {
+                DataChunk chunk;
+                rows.InitializeScanChunk(chunk);
+                rows.FetchChunk(i, chunk);
+                list.WriteObject([&](Serializer &object) { chunk.Serialize(object); });
+            });
+            serializer.End();
+            writer.Sync();
+        }
+        fs.MoveFile(temp_path, path);
+    } catch (std::exception &) {
+        RemoveFileIfExists(fs, temp_path);
+    }
+}
+
+void SheetDiskCache::Invalidate(const string &spreadsheet_id) const {
+    if (!Enabled()) {
+        return;
+    }
+    auto &fs = FileSystem::GetFileSystem(context);
+    try {
+        for (auto &path : fs.Glob(fs.JoinPath(directory, spreadsheet_id + "-*.gsheet"))) {
+            RemoveFileIfExists(fs, path);
+        }
+    } catch (std::exception &) {
+        // Entries that could not be listed are revalidated against the spreadsheet version once they expire
+    }
+}
+
+void SheetDiskCache::Clear() const {
+    if (!Enabled()) {
+        return;
+    }
+    auto &fs = FileSystem::GetFileSystem(context);
+    try {
+        for (auto &path : fs.Glob(fs.JoinPath(directory, "*.gsheet"))) {
+            RemoveFileIfExists(fs, path);
+        }
+    } catch (std::exception &) {
+        // Entries that could not be listed are left in place
+    }
+}
+
+} // namespace duckdb
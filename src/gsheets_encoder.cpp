@@ -0,0 +1,431 @@
+#include "gsheets_encoder.hpp"
+#include "gsheets_decoder.hpp"
+#include "duckdb/common/types/date.hpp"
+#include "duckdb/common/types/hugeint.hpp"
+#include "duckdb/common/types/interval.hpp"
+#include "duckdb/common/types/timestamp.hpp"
+#include "duckdb/common/types/uhugeint.hpp"
+#include "duckdb/common/vector_operations/vector_operations.hpp"
+
+#include <cmath>
+#include <cstdio>
+#include <type_traits>
+
+namespace duckdb {
+
+SheetRowEncoder::SheetRowEncoder(const vector<LogicalType> &types, SheetRowFormat format, bool comparable)
+    : types(types), format(format), number_formats(types.size()), columns(types.size()),
+      comparable_columns(comparable ? types.size() : 0) {
+    if (format != SheetRowFormat::CELLS) {
+        return;
+    }
+    for (idx_t col = 0; col < types.size(); col++) {
+        switch (types[col].id()) {
+        case LogicalTypeId::DATE:
+            number_formats[col] = "DATE";
+            break;
+        case LogicalTypeId::TIMESTAMP:
+            number_formats[col] = "DATE_TIME";
+            break;
+        case LogicalTypeId::TIME:
+            number_formats[col] = "TIME";
+            break;
+        default:
+            break;
+        }
+    }
+}
+
+// Writes a JSON string, escaping quotes, backslashes and control characters
+static void WriteString(const char *data, idx_t len, string &out) {
+    static const char *HEX_DIGITS = "0123456789abcdef";
+    out += '"';
+    idx_t start = 0;
+    for (idx_t i = 0; i < len; i++) {
+        auto c = static_cast<unsigned char>(data[i]);
+        if (c >= 0x20 && c != '"' && c != '\\') {
+            continue;
+        }
+        out.append(data + start, i - start);
+        start = i + 1;
+        switch (c) {
+        case '"':
+            out += "\\\"";
+            break;
+        case '\\':
+            out += "\\\\";
+            break;
+        case '\n':
+            out += "\\n";
+            break;
+        case '\r':
+            out += "\\r";
+            break;
+        case '\t':
+            out += "\\t";
+            break;
+        default:
+            out += "\\u00";
+            out += HEX_DIGITS[c >> 4];
+            out += HEX_DIGITS[c & 0xF];
+            break;
+        }
+    }
+    out.append(data + start, len - start);
+    out += '"';
+}
+
+template <class T>
+static void WriteInteger(T value, string &out) {
+    typedef typename std::make_unsigned<T>::type UNSIGNED;
+    char buffer[24];
+    char *end = buffer + sizeof(buffer);
+    char *ptr = end;
+    bool negative = value < T(0);
+    UNSIGNED remainder = negative ? UNSIGNED(0) - UNSIGNED(value) : UNSIGNED(value);
+    do {
+        *--ptr = static_cast<char>('0' + remainder % 10);
+        remainder /= 10;
+    } while (remainder != 0);
+    if (negative) {
+        *--ptr = '-';
+    }
+    out.append(ptr, end - ptr);
+}
+
+static void WriteSerial(double value, string &out) {
+    char buffer[32];
+    auto len = snprintf(buffer, sizeof(buffer), "%.17g", value);
+    out.append(buffer, len);
+}
+
+static void WriteBoolean(bool value, string &out) {
+    if (value) {
+        out.append("true", 4);
+    } else {
+        out.append("false", 5);
+    }
+}
+
+// Calls write for every valid cell and writes null_text for NULLs, an empty JSON string by default, recording where
+// each cell starts
+template <class T, class WRITE>
+static void EncodeCells(const UnifiedVectorFormat &format, idx_t count, string &out, vector<idx_t> &offsets,
+                        WRITE write, const char *null_text = "\"\"") {
+    auto data = UnifiedVectorFormat::GetData<T>(format);
+    for (idx_t row = 0; row < count; row++) {
+        offsets[row] = out.size();
+        auto idx = format.sel->get_index(row);
+        if (!format.validity.RowIsValid(idx)) {
+            out += null_text;
+            continue;
+        }
+        write(data[idx], out);
+    }
+    offsets[count] = out.size();
+}
+
+template <class T>
+static void EncodeIntegers(const UnifiedVectorFormat &format, idx_t count, string &out, vector<idx_t> &offsets) {
+    EncodeCells<T>(format, count, out, offsets, [](T value, string &out) { WriteInteger<T>(value, out); });
+}
+
+// Whether the VARCHAR cast of a floating point number is a valid JSON number, inf and nan are not
+static bool IsJSONNumber(const string_t &value) {
+    auto data = value.GetData();
+    auto len = value.GetSize();
+    for (idx_t i = 0; i < len; i++) {
+        if (data[i] == 'i' || data[i] == 'n') {
+            return false;
+        }
+    }
+    return len > 0;
+}
+
+void SheetRowEncoder::EncodeColumn(Vector &source, idx_t count, EncodedColumn &column, const char *number_format) {
+    auto &out = column.data;
+    auto &offsets = column.offsets;
+    out.clear();
+    offsets.resize(count + 1);
+
+    UnifiedVectorFormat format;
+    auto &type = source.GetType();
+    switch (type.id()) {
+    case LogicalTypeId::BOOLEAN:
+        source.ToUnifiedFormat(count, format);
+        EncodeCells<bool>(format, count, out, offsets, WriteBoolean);
+        return;
+    case LogicalTypeId::TINYINT:
+        source.ToUnifiedFormat(count, format);
+        EncodeIntegers<int8_t>(format, count, out, offsets);
+        return;
+    case LogicalTypeId::SMALLINT:
+        source.ToUnifiedFormat(count, format);
+        EncodeIntegers<int16_t>(format, count, out, offsets);
+        return;
+    case LogicalTypeId::INTEGER:
+        source.ToUnifiedFormat(count, format);
+        EncodeIntegers<int32_t>(format, count, out, offsets);
+        return;
+    case LogicalTypeId::BIGINT:
+        source.ToUnifiedFormat(count, format);
+        EncodeIntegers<int64_t>(format, count, out, offsets);
+        return;
+    case LogicalTypeId::UTINYINT:
+        source.ToUnifiedFormat(count, format);
+        EncodeIntegers<uint8_t>(format, count, out, offsets);
+        return;
+    case LogicalTypeId::USMALLINT:
+        source.ToUnifiedFormat(count, format);
+        EncodeIntegers<uint16_t>(format, count, out, offsets);
+        return;
+    case LogicalTypeId::UINTEGER:
+        source.ToUnifiedFormat(count, format);
+        EncodeIntegers<uint32_t>(format, count, out, offsets);
+        return;
+    case LogicalTypeId::UBIGINT:
+        source.ToUnifiedFormat(count, format);
+        EncodeIntegers<uint64_t>(format, count, out, offsets);
+        return;
+    case LogicalTypeId::HUGEINT:
+        source.ToUnifiedFormat(count, format);
+        EncodeCells<hugeint_t>(format, count, out, offsets,
+                               [](hugeint_t value, string &out) { out += Hugeint::ToString(value); });
+        return;
+    case LogicalTypeId::UHUGEINT:
+        source.ToUnifiedFormat(count, format);
+        EncodeCells<uhugeint_t>(format, count, out, offsets,
+                                [](uhugeint_t value, string &out) { out += Uhugeint::ToString(value); });
+        return;
+    case LogicalTypeId::DATE:
+    case LogicalTypeId::TIMESTAMP:
+    case LogicalTypeId::TIME:
+        if (!number_format) {
+            break;
+        }
+        // Written as the serial numbers of the sheet, infinite dates and timestamps as strings
+        source.ToUnifiedFormat(count, format);
+        if (type.id() == LogicalTypeId::DATE) {
+            EncodeCells<date_t>(format, count, out, offsets, [](date_t value, string &out) {
+                if (!Date::IsFinite(value)) {
+                    auto text = Date::ToString(value);
+                    WriteString(text.c_str(), text.size(), out);
+                    return;
+                }
+                WriteInteger<int64_t>(Date::EpochDays(value) + SERIAL_EPOCH_DAYS, out);
+            });
+        } else if (type.id() == LogicalTypeId::TIMESTAMP) {
+            EncodeCells<timestamp_t>(format, count, out, offsets, [](timestamp_t value, string &out) {
+                if (!Timestamp::IsFinite(value)) {
+                    auto text = Timestamp::ToString(value);
+                    WriteString(text.c_str(), text.size(), out);
+                    return;
+                }
+                auto days = double(Timestamp::GetEpochMicroSeconds(value)) / Interval::MICROS_PER_DAY;
+                WriteSerial(days + SERIAL_EPOCH_DAYS, out);
+            });
+        } else {
+            EncodeCells<dtime_t>(format, count, out, offsets, [](dtime_t value, string &out) {
+                WriteSerial(double(value.micros) / Interval::MICROS_PER_DAY, out);
+            });
+        }
+        return;
+    case LogicalTypeId::VARCHAR:
+        source.ToUnifiedFormat(count, format);
+        EncodeCells<string_t>(format, count, out, offsets,
+                              [](const string_t &value, string &out) { WriteString(value.GetData(), value.GetSize(), out); });
+        return;
+    default:
+        break;
+    }
+
+    // Every other type is written as its VARCHAR cast, which formats a whole vector at once
+    Vector strings(LogicalType::VARCHAR, count);
+    VectorOperations::DefaultCast(source, strings, count);
+    strings.ToUnifiedFormat(count, format);
+    switch (type.id()) {
+    case LogicalTypeId::FLOAT:
+    case LogicalTypeId::DOUBLE:
+    case LogicalTypeId::DECIMAL:
+        EncodeCells<string_t>(format, count, out, offsets, [](const string_t &value, string &out) {
+            if (IsJSONNumber(value)) {
+                out.append(value.GetData(), value.GetSize());
+            } else {
+                WriteString(value.GetData(), value.GetSize(), out);
+            }
+        });
+        break;
+    default:
+        EncodeCells<string_t>(format, count, out, offsets,
+                              [](const string_t &value, string &out) { WriteString(value.GetData(), value.GetSize(), out); });
+        break;
+    }
+}
+
+void SheetRowEncoder::AppendComparableNumber(double value, string &out) {
+    if (std::isnan(value)) {
+        out += "nan";
+    } else if (std::isinf(value)) {
+        out += value > 0 ? "inf" : "-inf";
+    } else {
+        // 15 significant digits, so that serial numbers computed here and by the sheet match despite rounding
+        char buffer[32];
+        auto len = snprintf(buffer, sizeof(buffer), "%.15g", value);
+        out.append(buffer, len);
+    }
+}
+
+void SheetRowEncoder::EncodeComparableColumn(Vector &source, idx_t count, EncodedColumn &column) {
+    auto &out = column.data;
+    auto &offsets = column.offsets;
+    out.clear();
+    offsets.resize(count + 1);
+
+    UnifiedVectorFormat format;
+    auto &type = source.GetType();
+    switch (type.id()) {
+    case LogicalTypeId::BOOLEAN:
+        source.ToUnifiedFormat(count, format);
+        EncodeCells<bool>(
+            format, count, out, offsets, [](bool value, string &out) { out += value ? "TRUE" : "FALSE"; }, "");
+        break;
+    case LogicalTypeId::DATE:
+        source.ToUnifiedFormat(count, format);
+        EncodeCells<date_t>(format, count, out, offsets, [](date_t value, string &out) {
+            if (!Date::IsFinite(value)) {
+                out += Date::ToString(value);
+                return;
+            }
+            AppendComparableNumber(double(Date::EpochDays(value) + SERIAL_EPOCH_DAYS), out);
+        }, "");
+        break;
+    case LogicalTypeId::TIMESTAMP:
+        source.ToUnifiedFormat(count, format);
+        EncodeCells<timestamp_t>(format, count, out, offsets, [](timestamp_t value, string &out) {
+            if (!Timestamp::IsFinite(value)) {
+                out += Timestamp::ToString(value);
+                return;
+            }
+            auto days = double(Timestamp::GetEpochMicroSeconds(value)) / Interval::MICROS_PER_DAY;
+            AppendComparableNumber(days + SERIAL_EPOCH_DAYS, out);
+        }, "");
+        break;
+    case LogicalTypeId::TIME:
+        source.ToUnifiedFormat(count, format);
+        EncodeCells<dtime_t>(format, count, out, offsets, [](dtime_t value, string &out) {
+            AppendComparableNumber(double(value.micros) / Interval::MICROS_PER_DAY, out);
+        }, "");
+        break;
+    case LogicalTypeId::TINYINT:
+    case LogicalTypeId::SMALLINT:
+    case LogicalTypeId::INTEGER:
+    case LogicalTypeId::BIGINT:
+    case LogicalTypeId::UTINYINT:
+    case LogicalTypeId::USMALLINT:
+    case LogicalTypeId::UINTEGER:
+    case LogicalTypeId::UBIGINT:
+    case LogicalTypeId::HUGEINT:
+    case LogicalTypeId::UHUGEINT:
+    case LogicalTypeId::FLOAT:
+    case LogicalTypeId::DOUBLE:
+    case LogicalTypeId::DECIMAL: {
+        // The sheet holds numbers as doubles
+        Vector doubles(LogicalType::DOUBLE, count);
+        VectorOperations::DefaultCast(source, doubles, count);
+        doubles.ToUnifiedFormat(count, format);
+        EncodeCells<double>(format, count, out, offsets, AppendComparableNumber, "");
+        break;
+    }
+    default: {
+        Vector strings(LogicalType::VARCHAR, count);
+        VectorOperations::DefaultCast(source, strings, count);
+        strings.ToUnifiedFormat(count, format);
+        EncodeCells<string_t>(format, count, out, offsets,
+                              [](const string_t &value, string &out) { out.append(value.GetData(), value.GetSize()); }, "");
+        break;
+    }
+    }
+}
+
+void SheetRowEncoder::SetChunk(DataChunk &chunk) {
+    D_ASSERT(chunk.ColumnCount() == types.size());
+    for (idx_t col = 0; col < chunk.ColumnCount(); col++) {
+        EncodeColumn(chunk.data[col], chunk.size(), columns[col], number_formats[col]);
+    }
+    for (idx_t col = 0; col < comparable_columns.size(); col++) {
+        EncodeComparableColumn(chunk.data[col], chunk.size(), comparable_columns[col]);
+    }
+}
+
+void SheetRowEncoder::GetComparableRow(idx_t row, vector<string> &cells) const {
+    D_ASSERT(comparable_columns.size() == types.size());
+    cells.resize(comparable_columns.size());
+    for (idx_t col = 0; col < comparable_columns.size(); col++) {
+        auto &column = comparable_columns[col];
+        auto start = column.offsets[row];
+        cells[col].assign(column.data, start, column.offsets[row + 1] - start);
+    }
+}
+
+// Appends the CellData of an encoded cell, typed by its JSON value. Empty strings leave the cell empty.
+static void AppendCellData(const char *cell, idx_t len, const char *number_format, string &out) {
+    if (len == 2 && cell[0] == '"') {
+        out.append("{}", 2);
+        return;
+    }
+    out += "{\"userEnteredValue\":{";
+    if (cell[0] == '"') {
+        out += "\"stringValue\":";
+    } else if (cell[0] == 't' || cell[0] == 'f') {
+        out += "\"boolValue\":";
+    } else {
+        out += "\"numberValue\":";
+    }
+    out.append(cell, len);
+    out += '}';
+    if (number_format && cell[0] != '"') {
+        out += ",\"userEnteredFormat\":{\"numberFormat\":{\"type\":\"";
+        out += number_format;
+        out += "\"}}";
+    }
+    out += '}';
+}
+
+void SheetRowEncoder::AppendRow(idx_t row, string &out) const {
+    bool cells = format == SheetRowFormat::CELLS;
+    out += cells ? "{\"values\":[" : "[";
+    for (idx_t col = 0; col < columns.size(); col++) {
+        if (col > 0) {
+            out += ',';
+        }
+        auto &column = columns[col];
+        auto start = column.offsets[row];
+        auto len = column.offsets[row + 1] - start;
+        if (cells) {
+            AppendCellData(column.data.data() + start, len, number_formats[col], out);
+        } else {
+            out.append(column.data, start, len);
+        }
+    }
+    out += cells ? "]}" : "]";
+}
+
+void SheetRowEncoder::AppendHeader(const vector<string> &names, SheetRowFormat format, string &out) {
+    bool cells = format == SheetRowFormat::CELLS;
+    out += cells ? "{\"values\":[" : "[";
+    for (idx_t col = 0; col < names.size(); col++) {
+        if (col > 0) {
+            out += ',';
+        }
+        string name;
+        WriteString(names[col].c_str(), names[col].size(), name);
+        if (cells) {
+            AppendCellData(name.c_str(), name.size(), nullptr, out);
+        } else {
+            out += name;
+        }
+    }
+    out += cells ? "]}" : "]";
+}
+
+} // namespace duckdb
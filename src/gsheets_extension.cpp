@@ -29,7 +29,11 @@
 #include "gsheets_extension.hpp"
 #include "gsheets_auth.hpp"
 #include "gsheets_copy.hpp"
+#include "gsheets_disk_cache.hpp"
+#include "gsheets_memory_cache.hpp"
+#include "gsheets_metadata_cache.hpp"
 #include "gsheets_read.hpp"
+#include "gsheets_requests.hpp"
 
 // OpenSSL linked through vcpkg
 #include <openssl/opensslv.h>
@@ -76,20 +80,73 @@ static void LoadInternal(DatabaseInstance &instance) {
     
 
     // Register read_gsheet table function
-    TableFunction read_gsheet_function("read_gsheet", {LogicalType::VARCHAR}, ReadSheetFunction, ReadSheetBind);
+    TableFunction read_gsheet_function("read_gsheet", {LogicalType::VARCHAR}, ReadSheetFunction, ReadSheetBind,
+                                       ReadSheetInitGlobal, ReadSheetInitLocal);
+    read_gsheet_function.get_batch_index = ReadSheetGetBatchIndex;
+    read_gsheet_function.projection_pushdown = true;
     read_gsheet_function.named_parameters["header"] = LogicalType::BOOLEAN;
     read_gsheet_function.named_parameters["sheet"] = LogicalType::VARCHAR;
-    ExtensionUtil::RegisterFunction(instance, read_gsheet_function);
+    read_gsheet_function.named_parameters["batch_rows"] = LogicalType::BIGINT;
+    read_gsheet_function.named_parameters["range"] = LogicalType::VARCHAR;
+    read_gsheet_function.named_parameters["skip"] = LogicalType::BIGINT;
+    read_gsheet_function.named_parameters["max_rows"] = LogicalType::BIGINT;
+    read_gsheet_function.named_parameters["sample_size"] = LogicalType::BIGINT;
+    read_gsheet_function.named_parameters["columns"] = LogicalType::ANY;
+    read_gsheet_function.named_parameters["value_render_option"] = LogicalType::VARCHAR;
+    read_gsheet_function.named_parameters["sheets"] = LogicalType::ANY;
+    read_gsheet_function.named_parameters["sheet_name"] = LogicalType::BOOLEAN;
+    read_gsheet_function.named_parameters["filename"] = LogicalType::BOOLEAN;
+    // read_gsheet takes a spreadsheet, or a list of spreadsheets read into one table
+    TableFunctionSet read_gsheet_set("read_gsheet");
+    read_gsheet_set.AddFunction(read_gsheet_function);
+    read_gsheet_function.arguments = {LogicalType::LIST(LogicalType::VARCHAR)};
+    read_gsheet_set.AddFunction(read_gsheet_function);
+    ExtensionUtil::RegisterFunction(instance, read_gsheet_set);
 
     // Register COPY TO (FORMAT 'gsheet') function
     GSheetCopyFunction gsheet_copy_function;
     ExtensionUtil::RegisterFunction(instance, gsheet_copy_function);
 
+    // Register PRAGMA gsheets_cache_clear_metadata, optionally for a single spreadsheet
+    PragmaFunctionSet clear_metadata_cache("gsheets_cache_clear_metadata");
+    clear_metadata_cache.AddFunction(
+        PragmaFunction::PragmaStatement("gsheets_cache_clear_metadata", ClearMetadataCachePragma));
+    clear_metadata_cache.AddFunction(PragmaFunction::PragmaCall(
+        "gsheets_cache_clear_metadata", ClearSpreadsheetMetadataCachePragma, {LogicalType::VARCHAR}));
+    ExtensionUtil::RegisterFunction(instance, clear_metadata_cache);
+
+    // Register PRAGMA gsheets_cache_clear and duckdb_gsheets_cache(), for the cache of read_gsheet results
+    ExtensionUtil::RegisterFunction(instance, PragmaFunction::PragmaStatement("gsheets_cache_clear", ClearSheetCachePragma));
+    TableFunction sheet_cache_function("duckdb_gsheets_cache", {}, SheetCacheFunction, SheetCacheBind,
+                                       SheetCacheInitGlobal);
+    ExtensionUtil::RegisterFunction(instance, sheet_cache_function);
+
     // Register Secret functions
 	CreateGsheetSecretFunctions::Register(instance);
 
     // Register replacement scan for read_gsheet
     auto &config = DBConfig::GetConfig(instance);
+    config.AddExtensionOption(SpreadsheetMetadataCache::TTL_SETTING,
+                              "Seconds spreadsheet metadata is cached for, 0 disables the cache", LogicalType::BIGINT,
+                              Value::BIGINT(SpreadsheetMetadataCache::DEFAULT_TTL_SECONDS));
+    config.AddExtensionOption(SheetMemoryCache::MEMORY_LIMIT_SETTING,
+                              "Memory read_gsheet results are cached in, shared by the connections of the database, "
+                              "'0MB' disables the memory cache",
+                              LogicalType::VARCHAR, Value(SheetMemoryCache::DEFAULT_MEMORY_LIMIT));
+    config.AddExtensionOption(SheetDiskCache::DIRECTORY_SETTING,
+                              "Directory read_gsheet results are cached in, empty disables the disk cache",
+                              LogicalType::VARCHAR, Value(""));
+    config.AddExtensionOption(SheetDiskCache::TTL_SETTING,
+                              "Seconds cached read_gsheet results are used for before they are revalidated against the "
+                              "spreadsheet version",
+                              LogicalType::BIGINT, Value::BIGINT(SheetDiskCache::DEFAULT_TTL_SECONDS));
+    config.AddExtensionOption(RequestSettings::REQUESTS_PER_MINUTE_SETTING,
+                              "Google Sheets API requests per minute allowed per user, for reads and for writes each, "
+                              "0 disables rate limiting",
+                              LogicalType::DOUBLE, Value::DOUBLE(DEFAULT_REQUESTS_PER_MINUTE));
+    config.AddExtensionOption(RequestSettings::MAX_RETRIES_SETTING,
+                              "Times a throttled or failed Google Sheets API request is retried, with backoff",
+                              LogicalType::BIGINT, Value::BIGINT(DEFAULT_MAX_REQUEST_RETRIES));
     config.replacement_scans.emplace_back(ReadSheetReplacement);
 }
 
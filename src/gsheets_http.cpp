@@ -0,0 +1,303 @@
+#include "gsheets_http.hpp"
+#include "duckdb/common/exception.hpp"
+#include "duckdb/common/string_util.hpp"
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+namespace duckdb
+{
+
+    GzipInflater::GzipInflater()
+    {
+        memset(&stream, 0, sizeof(stream));
+        // 16 + MAX_WBITS selects the gzip wrapper
+        if (inflateInit2(&stream, 16 + MAX_WBITS) != Z_OK)
+        {
+            throw duckdb::IOException("Failed to initialize gzip decompression");
+        }
+    }
+
+    GzipInflater::~GzipInflater()
+    {
+        inflateEnd(&stream);
+    }
+
+    void GzipInflater::Inflate(const char *data, size_t len, std::string &out)
+    {
+        if (finished)
+        {
+            return;
+        }
+        stream.next_in = reinterpret_cast<Bytef *>(const_cast<char *>(data));
+        stream.avail_in = static_cast<uInt>(len);
+        do
+        {
+            stream.next_out = reinterpret_cast<Bytef *>(buffer);
+            stream.avail_out = sizeof(buffer);
+            int result = inflate(&stream, Z_NO_FLUSH);
+            if (result == Z_STREAM_END)
+            {
+                finished = true;
+            }
+            else if (result != Z_OK && result != Z_BUF_ERROR)
+            {
+                throw duckdb::IOException("Failed to decompress gzip response: %s",
+                                          std::string(stream.msg ? stream.msg : "corrupt data"));
+            }
+            out.append(buffer, sizeof(buffer) - stream.avail_out);
+        } while (!finished && (stream.avail_in > 0 || stream.avail_out == 0));
+    }
+
+    bool HttpResponseParser::Feed(const char *data, size_t len)
+    {
+        size_t pos = 0;
+        while (pos < len && state != State::DONE)
+        {
+            if (state == State::BODY || state == State::CHUNK_DATA || state == State::BODY_UNTIL_CLOSE)
+            {
+                size_t available = len - pos;
+                size_t take = state == State::BODY_UNTIL_CLOSE ? available : std::min(remaining, available);
+                AppendBody(data + pos, take);
+                pos += take;
+                if (state == State::BODY_UNTIL_CLOSE)
+                {
+                    continue;
+                }
+                remaining -= take;
+                if (remaining == 0)
+                {
+                    if (state == State::CHUNK_DATA)
+                    {
+                        state = State::CHUNK_END;
+                    }
+                    else
+                    {
+                        Complete();
+                    }
+                }
+                continue;
+            }
+
+            // Every other state is line based
+            auto newline = static_cast<const char *>(memchr(data + pos, '\n', len - pos));
+            size_t line_end = newline ? newline - data : len;
+            line.append(data + pos, line_end - pos);
+            pos = line_end;
+            if (!newline)
+            {
+                break;
+            }
+            pos++;
+            if (!line.empty() && line.back() == '\r')
+            {
+                line.pop_back();
+            }
+            ParseLine();
+            line.clear();
+        }
+        return state == State::DONE;
+    }
+
+    bool HttpResponseParser::Finish()
+    {
+        if (state == State::BODY_UNTIL_CLOSE)
+        {
+            Complete();
+        }
+        return state == State::DONE;
+    }
+
+    void HttpResponseParser::ParseLine()
+    {
+        switch (state)
+        {
+        case State::STATUS_LINE:
+            ParseStatusLine();
+            break;
+        case State::HEADERS:
+            if (line.empty())
+            {
+                BeginBody();
+            }
+            else
+            {
+                ParseHeader();
+            }
+            break;
+        case State::CHUNK_SIZE:
+        {
+            // Chunk extensions after ';' are ignored
+            size_t size_end = line.find(';');
+            std::string size_str = line.substr(0, size_end);
+            StringUtil::Trim(size_str);
+            if (size_str.empty() || size_str.find_first_not_of("0123456789abcdefABCDEF") != std::string::npos)
+            {
+                throw duckdb::IOException("Invalid chunk size in HTTP response: %s", line);
+            }
+            remaining = std::stoul(size_str, nullptr, 16);
+            state = remaining == 0 ? State::TRAILERS : State::CHUNK_DATA;
+            if (remaining != 0 && !inflater)
+            {
+                response.body.reserve(response.body.size() + remaining);
+            }
+            break;
+        }
+        case State::CHUNK_END:
+            if (!line.empty())
+            {
+                throw duckdb::IOException("Malformed chunk in HTTP response");
+            }
+            state = State::CHUNK_SIZE;
+            break;
+        case State::TRAILERS:
+            // Trailers are normally absent, they are skipped up to the final empty line
+            if (line.empty())
+            {
+                Complete();
+            }
+            break;
+        default:
+            break;
+        }
+    }
+
+    void HttpResponseParser::ParseStatusLine()
+    {
+        // HTTP/1.1 200 OK
+        if (!StringUtil::StartsWith(line, "HTTP/"))
+        {
+            throw duckdb::IOException("Invalid HTTP status line: %s", line);
+        }
+        size_t code_start = line.find(' ');
+        if (code_start == std::string::npos || line.size() < code_start + 4)
+        {
+            throw duckdb::IOException("Invalid HTTP status line: %s", line);
+        }
+        response.status = std::atoi(line.c_str() + code_start + 1);
+        // HTTP/1.0 connections are closed after the response unless asked otherwise
+        keep_alive = !StringUtil::StartsWith(line, "HTTP/1.0");
+        state = State::HEADERS;
+    }
+
+    void HttpResponseParser::ParseHeader()
+    {
+        size_t colon = line.find(':');
+        if (colon == std::string::npos)
+        {
+            throw duckdb::IOException("Invalid HTTP header: %s", line);
+        }
+        std::string name = StringUtil::Lower(line.substr(0, colon));
+        std::string value = line.substr(colon + 1);
+        StringUtil::Trim(name);
+        StringUtil::Trim(value);
+        auto entry = response.headers.find(name);
+        if (entry != response.headers.end())
+        {
+            entry->second += ", " + value;
+        }
+        else
+        {
+            response.headers.emplace(std::move(name), std::move(value));
+        }
+    }
+
+    void HttpResponseParser::BeginBody()
+    {
+        auto connection = response.headers.find("connection");
+        if (connection != response.headers.end())
+        {
+            std::string value = StringUtil::Lower(connection->second);
+            if (value.find("close") != std::string::npos)
+            {
+                keep_alive = false;
+            }
+            else if (value.find("keep-alive") != std::string::npos)
+            {
+                keep_alive = true;
+            }
+        }
+
+        // Interim responses, e.g. 100 Continue, precede the final response on the same connection, which is read
+        // next. 101 Switching Protocols is final.
+        if (response.status / 100 == 1 && response.status != 101)
+        {
+            response.status = 0;
+            response.headers.clear();
+            state = State::STATUS_LINE;
+            return;
+        }
+        // 101, 204 and 304 responses never have a body
+        if (response.status == 101 || response.status == 204 || response.status == 304)
+        {
+            state = State::DONE;
+            return;
+        }
+        auto content_encoding = response.headers.find("content-encoding");
+        if (content_encoding != response.headers.end())
+        {
+            std::string encoding = StringUtil::Lower(content_encoding->second);
+            if (encoding == "gzip" || encoding == "x-gzip")
+            {
+                inflater.reset(new GzipInflater());
+            }
+            else if (encoding != "identity")
+            {
+                throw duckdb::IOException("Unsupported Content-Encoding in HTTP response: %s", encoding);
+            }
+        }
+        auto transfer_encoding = response.headers.find("transfer-encoding");
+        if (transfer_encoding != response.headers.end() &&
+            StringUtil::Lower(transfer_encoding->second).find("chunked") != std::string::npos)
+        {
+            state = State::CHUNK_SIZE;
+            return;
+        }
+        auto content_length = response.headers.find("content-length");
+        if (content_length != response.headers.end())
+        {
+            if (content_length->second.empty() ||
+                content_length->second.find_first_not_of("0123456789") != std::string::npos)
+            {
+                throw duckdb::IOException("Invalid Content-Length in HTTP response: %s", content_length->second);
+            }
+            remaining = std::stoul(content_length->second);
+            if (remaining == 0)
+            {
+                state = State::DONE;
+                return;
+            }
+            // A compressed body inflates to an unknown size, the body grows as it is decompressed
+            if (!inflater)
+            {
+                response.body.reserve(remaining);
+            }
+            state = State::BODY;
+            return;
+        }
+        // Without framing the body ends when the server closes the connection
+        keep_alive = false;
+        state = State::BODY_UNTIL_CLOSE;
+    }
+
+    void HttpResponseParser::AppendBody(const char *data, size_t len)
+    {
+        if (inflater)
+        {
+            inflater->Inflate(data, len, response.body);
+        }
+        else
+        {
+            response.body.append(data, len);
+        }
+    }
+
+    void HttpResponseParser::Complete()
+    {
+        if (inflater && !inflater->Finished())
+        {
+            throw duckdb::IOException("Truncated gzip response");
+        }
+        state = State::DONE;
+    }
+
+} // namespace duckdb
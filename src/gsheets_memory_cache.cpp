@@ -0,0 +1,213 @@
+#include "gsheets_memory_cache.hpp"
+#include "duckdb/main/config.hpp"
+
+#include <chrono>
+
+namespace duckdb {
+
+SheetMemoryCache &SheetMemoryCache::Get(ClientContext &context) {
+    auto &cache = ObjectCache::GetObjectCache(context);
+    return *cache.GetOrCreate<SheetMemoryCache>(ObjectType());
+}
+
+idx_t SheetMemoryCache::GetMemoryLimit(ClientContext &context) {
+    Value limit;
+    if (context.TryGetCurrentSetting(MEMORY_LIMIT_SETTING, limit) && !limit.IsNull()) {
+        return DBConfig::ParseMemoryLimit(limit.ToString());
+    }
+    return DBConfig::ParseMemoryLimit(DEFAULT_MEMORY_LIMIT);
+}
+
+static string EntryKey(const string &spreadsheet_id, const string &key) {
+    return spreadsheet_id + "\n" + key;
+}
+
+void SheetMemoryCache::Erase(unordered_map<string, Entry>::iterator entry) {
+    lru.erase(entry->second.lru_position);
+    memory_bytes -= entry->second.memory_bytes;
+    entries.erase(entry);
+}
+
+static int64_t CurrentTime() {
+    return std::chrono::duration_cast<std::chrono::seconds>(std::chrono::system_clock::now().time_since_epoch())
+        .count();
+}
+
+bool SheetMemoryCache::LookupRead(ClientContext &context, const string &spreadsheet_id, const string &key,
+                                  vector<string> &names, vector<LogicalType> &types) {
+    auto ttl = GetSheetCacheTTL(context);
+    lock_guard<mutex> guard(lock);
+    auto entry = entries.find(EntryKey(spreadsheet_id, key));
+    if (entry == entries.end()) {
+        // Misses of reads that are not cached are counted once they are stored
+        return false;
+    }
+    if (CurrentTime() - entry->second.read_at >= ttl) {
+        Erase(entry);
+        return false;
+    }
+    entry->second.hits++;
+    lru.splice(lru.begin(), lru, entry->second.lru_position);
+    names = entry->second.names;
+    types = entry->second.types;
+    return true;
+}
+
+void SheetMemoryCache::StoreRead(ClientContext &context, const string &spreadsheet_id, const string &key,
+                                 const string &sheet_name, const vector<string> &names,
+                                 const vector<LogicalType> &types) {
+    auto limit = GetMemoryLimit(context);
+    auto entry_key = EntryKey(spreadsheet_id, key);
+    idx_t schema_bytes = entry_key.size();
+    for (idx_t i = 0; i < names.size(); i++) {
+        schema_bytes += names[i].size() + sizeof(LogicalType);
+    }
+
+    lock_guard<mutex> guard(lock);
+    auto existing = entries.find(entry_key);
+    if (existing != entries.end()) {
+        // Another bind of the read missed at the same time, its windows are kept
+        existing->second.misses++;
+        return;
+    }
+    if (!MakeRoom(schema_bytes, limit, entry_key)) {
+        return;
+    }
+    auto &entry = entries[entry_key];
+    entry.spreadsheet_id = spreadsheet_id;
+    entry.sheet_name = sheet_name;
+    entry.read_at = CurrentTime();
+    entry.names = names;
+    entry.types = types;
+    entry.memory_bytes = schema_bytes;
+    // The read was stored after missing
+    entry.misses = 1;
+    lru.push_front(entry_key);
+    entry.lru_position = lru.begin();
+    memory_bytes += schema_bytes;
+}
+
+shared_ptr<CachedWindow> SheetMemoryCache::LookupWindow(const string &spreadsheet_id, const string &key,
+                                                        const string &window_key) {
+    lock_guard<mutex> guard(lock);
+    auto entry = entries.find(EntryKey(spreadsheet_id, key));
+    if (entry == entries.end()) {
+        return nullptr;
+    }
+    auto window = entry->second.windows.find(window_key);
+    if (window == entry->second.windows.end()) {
+        return nullptr;
+    }
+    lru.splice(lru.begin(), lru, entry->second.lru_position);
+    return window->second;
+}
+
+void SheetMemoryCache::StoreWindow(ClientContext &context, const string &spreadsheet_id, const string &key,
+                                   const string &window_key, shared_ptr<CachedWindow> window) {
+    auto limit = GetMemoryLimit(context);
+    auto window_bytes = window->rows->SizeInBytes() + window_key.size();
+    auto entry_key = EntryKey(spreadsheet_id, key);
+
+    lock_guard<mutex> guard(lock);
+    auto entry = entries.find(entry_key);
+    // The read expired or was evicted while it was scanned, or another scan cached the window first
+    if (entry == entries.end() || entry->second.windows.count(window_key) > 0) {
+        return;
+    }
+    if (!MakeRoom(window_bytes, limit, entry_key)) {
+        return;
+    }
+    entry->second.row_count += window->rows->Count();
+    entry->second.memory_bytes += window_bytes;
+    entry->second.windows.emplace(window_key, std::move(window));
+    memory_bytes += window_bytes;
+}
+
+bool SheetMemoryCache::MakeRoom(idx_t bytes, idx_t limit, const string &keep) {
+    auto kept = entries.find(keep);
+    idx_t kept_bytes = kept == entries.end() ? 0 : kept->second.memory_bytes;
+    if (kept_bytes + bytes > limit) {
+        // Reads larger than the whole cache are not cached
+        return false;
+    }
+    // Evict from the least recently used end, erasing an entry leaves the position after it valid
+    auto position = lru.end();
+    while (memory_bytes + bytes > limit && position != lru.begin()) {
+        auto candidate = std::prev(position);
+        if (*candidate == keep) {
+            position = candidate;
+            continue;
+        }
+        Erase(entries.find(*candidate));
+    }
+    return true;
+}
+
+void SheetMemoryCache::Invalidate(const string &spreadsheet_id) {
+    lock_guard<mutex> guard(lock);
+    for (auto entry = entries.begin(); entry != entries.end();) {
+        auto current = entry++;
+        if (current->second.spreadsheet_id == spreadsheet_id) {
+            Erase(current);
+        }
+    }
+}
+
+void SheetMemoryCache::Clear() {
+    lock_guard<mutex> guard(lock);
+    entries.clear();
+    lru.clear();
+    memory_bytes = 0;
+}
+
+vector<SheetMemoryCache::EntryInfo> SheetMemoryCache::GetEntries() {
+    lock_guard<mutex> guard(lock);
+    vector<EntryInfo> result;
+    for (auto &entry : entries) {
+        auto &value = entry.second;
+        result.push_back(EntryInfo {value.spreadsheet_id, value.sheet_name, value.row_count, value.memory_bytes,
+                                    value.hits, value.misses});
+    }
+    return result;
+}
+
+void ClearSheetCachePragma(ClientContext &context, const FunctionParameters &parameters) {
+    SheetMemoryCache::Get(context).Clear();
+    SheetDiskCache(context).Clear();
+}
+
+struct SheetCacheGlobalState : public GlobalTableFunctionState {
+    vector<SheetMemoryCache::EntryInfo> entries;
+    idx_t offset = 0;
+};
+
+unique_ptr<FunctionData> SheetCacheBind(ClientContext &context, TableFunctionBindInput &input,
+                                        vector<LogicalType> &return_types, vector<string> &names) {
+    names = {"spreadsheet_id", "sheet", "row_count", "memory_bytes", "hits", "misses"};
+    return_types = {LogicalType::VARCHAR, LogicalType::VARCHAR, LogicalType::UBIGINT,
+                    LogicalType::UBIGINT, LogicalType::UBIGINT, LogicalType::UBIGINT};
+    return make_uniq<TableFunctionData>();
+}
+
+unique_ptr<GlobalTableFunctionState> SheetCacheInitGlobal(ClientContext &context, TableFunctionInitInput &input) {
+    auto result = make_uniq<SheetCacheGlobalState>();
+    result->entries = SheetMemoryCache::Get(context).GetEntries();
+    return std::move(result);
+}
+
+void SheetCacheFunction(ClientContext &context, TableFunctionInput &data_p, DataChunk &output) {
+    auto &state = data_p.global_state->Cast<SheetCacheGlobalState>();
+    idx_t count = 0;
+    for (; state.offset < state.entries.size() && count < STANDARD_VECTOR_SIZE; state.offset++, count++) {
+        auto &entry = state.entries[state.offset];
+        output.SetValue(0, count, Value(entry.spreadsheet_id));
+        output.SetValue(1, count, Value(entry.sheet_name));
+        output.SetValue(2, count, Value::UBIGINT(entry.row_count));
+        output.SetValue(3, count, Value::UBIGINT(entry.memory_bytes));
+        output.SetValue(4, count, Value::UBIGINT(entry.hits));
+        output.SetValue(5, count, Value::UBIGINT(entry.misses));
+    }
+    output.SetCardinality(count);
+}
+
+} // namespace duckdb
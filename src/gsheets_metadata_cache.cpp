@@ -0,0 +1,87 @@
+#include "gsheets_metadata_cache.hpp"
+#include "gsheets_requests.hpp"
+#include "duckdb/common/exception.hpp"
+
+namespace duckdb {
+
+SpreadsheetMetadataCache &SpreadsheetMetadataCache::Get(ClientContext &context) {
+    auto &cache = ObjectCache::GetObjectCache(context);
+    return *cache.GetOrCreate<SpreadsheetMetadataCache>(ObjectType());
+}
+
+static std::chrono::seconds GetCacheTTL(ClientContext &context) {
+    Value ttl;
+    if (context.TryGetCurrentSetting(SpreadsheetMetadataCache::TTL_SETTING, ttl) && !ttl.IsNull()) {
+        return std::chrono::seconds(MaxValue<int64_t>(ttl.GetValue<int64_t>(), 0));
+    }
+    return std::chrono::seconds(SpreadsheetMetadataCache::DEFAULT_TTL_SECONDS);
+}
+
+vector<SheetProperties> SpreadsheetMetadataCache::GetSheets(ClientContext &context, const string &spreadsheet_id,
+                                                            const string &token) {
+    auto ttl = GetCacheTTL(context);
+    auto now = std::chrono::steady_clock::now();
+    auto key = spreadsheet_id + "\n" + get_token_key(token);
+    {
+        lock_guard<mutex> guard(lock);
+        auto entry = entries.find(key);
+        if (entry != entries.end() && now - entry->second.fetched_at < ttl) {
+            return entry->second.sheets;
+        }
+    }
+
+    // Fetch outside of the lock, so lookups of other spreadsheets are not held up by the request
+    auto sheets = get_spreadsheet_sheets(spreadsheet_id, token, GetRequestSettings(context));
+    if (ttl.count() > 0) {
+        lock_guard<mutex> guard(lock);
+        entries[key] = Entry {spreadsheet_id, sheets, now};
+    }
+    return sheets;
+}
+
+SheetProperties SpreadsheetMetadataCache::GetSheetById(ClientContext &context, const string &spreadsheet_id,
+                                                       const string &sheet_id, const string &token) {
+    for (auto &sheet : GetSheets(context, spreadsheet_id, token)) {
+        if (sheet.sheet_id == sheet_id) {
+            return sheet;
+        }
+    }
+    throw InvalidInputException("Sheet with ID %s not found", sheet_id);
+}
+
+SheetProperties SpreadsheetMetadataCache::GetSheetByName(ClientContext &context, const string &spreadsheet_id,
+                                                         const string &sheet_name, const string &token) {
+    for (auto &sheet : GetSheets(context, spreadsheet_id, token)) {
+        if (sheet.title == sheet_name) {
+            return sheet;
+        }
+    }
+    throw InvalidInputException("Sheet with name %s not found", sheet_name);
+}
+
+void SpreadsheetMetadataCache::Invalidate(const string &spreadsheet_id) {
+    lock_guard<mutex> guard(lock);
+    for (auto entry = entries.begin(); entry != entries.end();) {
+        if (entry->second.spreadsheet_id == spreadsheet_id) {
+            entry = entries.erase(entry);
+        } else {
+            entry++;
+        }
+    }
+}
+
+void SpreadsheetMetadataCache::Clear() {
+    lock_guard<mutex> guard(lock);
+    entries.clear();
+}
+
+void ClearMetadataCachePragma(ClientContext &context, const FunctionParameters &parameters) {
+    SpreadsheetMetadataCache::Get(context).Clear();
+}
+
+void ClearSpreadsheetMetadataCachePragma(ClientContext &context, const FunctionParameters &parameters) {
+    auto spreadsheet_id = extract_spreadsheet_id(parameters.values[0].GetValue<string>());
+    SpreadsheetMetadataCache::Get(context).Invalidate(spreadsheet_id);
+}
+
+} // namespace duckdb
@@ -1,114 +1,775 @@
 #include "gsheets_read.hpp"
+#include "gsheets_decoder.hpp"
+#include "gsheets_disk_cache.hpp"
+#include "gsheets_memory_cache.hpp"
+#include "gsheets_metadata_cache.hpp"
 #include "gsheets_utils.hpp"
 #include "duckdb/common/exception.hpp"
+#include "duckdb/common/operator/cast_operators.hpp"
 #include "duckdb/common/string_util.hpp"
+#include "duckdb/common/types/date.hpp"
+#include "duckdb/common/types/timestamp.hpp"
 #include "duckdb/main/secret/secret_manager.hpp"
+#include "duckdb/parallel/task_scheduler.hpp"
 #include "gsheets_requests.hpp"
-#include <json.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <deque>
 
 namespace duckdb {
 
-using json = nlohmann::json;
+ReadSheetBindData::ReadSheetBindData(string token, bool header)
+    : token(std::move(token)), header(header), batch_rows(DEFAULT_BATCH_ROWS), first_row(1), first_column(0) {
+}
+
+idx_t ReadSheetBindData::FirstDataRow() const {
+    return header ? first_row + 1 : first_row;
+}
+
+// The sheet rows [first_row, last_row] of the sheet columns [first_column, last_column], e.g. 'Sheet1'!A1:C2
+static string GetSheetRange(const SheetPart &part, idx_t first_column, idx_t last_column, idx_t first_row,
+                            idx_t last_row) {
+    return part.sheet_name + "!" + column_index_to_letter(first_column) + std::to_string(first_row) + ":" +
+           column_index_to_letter(last_column) + std::to_string(last_row);
+}
+
+// The text a cell of a spreadsheets GET with grid data is sniffed from. Numbers formatted as dates and date times are
+// written as dates and timestamps, so that their columns are sniffed as the types their serial numbers are read as.
+static string SampledCellText(const json &cell) {
+    auto value = cell.find("effectiveValue");
+    if (value == cell.end()) {
+        return "";
+    }
+    if (value->contains("stringValue")) {
+        return (*value)["stringValue"].get<string>();
+    }
+    if (value->contains("boolValue")) {
+        return (*value)["boolValue"].get<bool>() ? "TRUE" : "FALSE";
+    }
+    if (!value->contains("numberValue")) {
+        // An error value, e.g. #DIV/0!
+        return "#ERROR!";
+    }
+    auto &number = (*value)["numberValue"];
+    auto format = cell.value(json::json_pointer("/effectiveFormat/numberFormat/type"), string());
+    if (format == "DATE") {
+        date_t date;
+        if (SheetSerialToDate(number.get<double>(), date)) {
+            return Date::ToString(date);
+        }
+    } else if (format == "DATE_TIME") {
+        timestamp_t timestamp;
+        if (SheetSerialToTimestamp(number.get<double>(), timestamp)) {
+            return Timestamp::ToString(timestamp);
+        }
+    }
+    return number.dump();
+}
+
+// Requests the sheet rows [first_row, last_row] of an unformatted read, with the number format of every cell
+static std::future<HttpResponse> RequestSheetCells(const ReadSheetBindData &bind_data, const SheetPart &part, idx_t last_row) {
+    auto range = GetSheetRange(part, bind_data.first_column, part.last_column, bind_data.first_row, last_row);
+    return get_sheet_cells_async(part.spreadsheet_id, bind_data.token, bind_data.request_settings, range);
+}
+
+// Decodes the cells of a spreadsheets GET with grid data as rows of strings
+static vector<vector<string>> DecodeSheetCells(const string &body) {
+    vector<vector<string>> rows;
+    auto data = parseJson(body);
+    auto row_data = data.value(json::json_pointer("/sheets/0/data/0/rowData"), json::array());
+    for (auto &grid_row : row_data) {
+        vector<string> row;
+        auto cells = grid_row.find("values");
+        if (cells != grid_row.end()) {
+            for (auto &cell : *cells) {
+                row.push_back(SampledCellText(cell));
+            }
+        }
+        // Cells that are only formatted have no value, like trailing empty cells of a values response they do not
+        // add columns
+        while (!row.empty() && row.back().empty()) {
+            row.pop_back();
+        }
+        rows.push_back(std::move(row));
+    }
+    return rows;
+}
+
+// Requests the ranges of a spreadsheet with a single values:batchGet
+static std::future<HttpResponse> RequestRanges(const ReadSheetBindData &bind_data, const string &spreadsheet_id,
+                                               const vector<string> &ranges) {
+    if (ranges.empty()) {
+        // None of the requested columns lie within the grids of the sheets, they hold no rows
+        std::promise<HttpResponse> empty;
+        HttpResponse response;
+        response.status = 200;
+        response.body = "{}";
+        empty.set_value(std::move(response));
+        return empty.get_future();
+    }
+    return batch_get_sheet_values_async(spreadsheet_id, bind_data.token, bind_data.request_settings, ranges,
+                                        bind_data.render_options);
+}
+
+// Waits for a response, and returns its body
+static string GetResponseBody(std::future<HttpResponse> &request) {
+    auto response = request.get();
+    if (!response.IsSuccess()) {
+        throw IOException("Error reading from Google Sheet: %s", get_response_error(response));
+    }
+    return std::move(response.body);
+}
+
+// Waits for a response shared by several threads, and returns its body, which lives as long as the response
+static const string &GetResponseBody(const std::shared_future<HttpResponse> &request) {
+    auto &response = request.get();
+    if (!response.IsSuccess()) {
+        throw IOException("Error reading from Google Sheet: %s", get_response_error(response));
+    }
+    return response.body;
+}
+
+// Samples the sheet rows [first_row, sample_last_rows[i]] of every sheet as rows of strings. The sheets of a
+// spreadsheet are sampled together with a single values:batchGet, and every request is in flight at once.
+static vector<vector<vector<string>>> SampleSheets(const ReadSheetBindData &bind_data,
+                                                   const vector<idx_t> &sample_last_rows) {
+    // The sheets sampled, grouped by spreadsheet
+    vector<std::pair<string, vector<idx_t>>> spreadsheets;
+    for (idx_t p = 0; p < bind_data.parts.size(); p++) {
+        auto &part = bind_data.parts[p];
+        if (bind_data.first_row > sample_last_rows[p] || bind_data.first_column > part.last_column) {
+            continue;
+        }
+        auto entry = std::find_if(spreadsheets.begin(), spreadsheets.end(),
+                                  [&](const std::pair<string, vector<idx_t>> &e) { return e.first == part.spreadsheet_id; });
+        if (entry == spreadsheets.end()) {
+            spreadsheets.emplace_back(part.spreadsheet_id, vector<idx_t>());
+            entry = spreadsheets.end() - 1;
+        }
+        entry->second.push_back(p);
+    }
+
+    // Unformatted reads sample every sheet with its own request, since a spreadsheets GET returns grid data of the
+    // first range only
+    vector<std::pair<vector<idx_t>, std::future<HttpResponse>>> requests;
+    for (auto &spreadsheet : spreadsheets) {
+        if (!bind_data.render_options.empty()) {
+            for (auto p : spreadsheet.second) {
+                requests.emplace_back(vector<idx_t> {p}, RequestSheetCells(bind_data, bind_data.parts[p], sample_last_rows[p]));
+            }
+            continue;
+        }
+        vector<string> ranges;
+        for (auto p : spreadsheet.second) {
+            auto &part = bind_data.parts[p];
+            ranges.push_back(GetSheetRange(part, bind_data.first_column, part.last_column, bind_data.first_row,
+                                           sample_last_rows[p]));
+        }
+        requests.emplace_back(spreadsheet.second, RequestRanges(bind_data, spreadsheet.first, ranges));
+    }
+
+    vector<vector<vector<string>>> samples(bind_data.parts.size());
+    for (auto &request : requests) {
+        auto &parts = request.first;
+        auto body = GetResponseBody(request.second);
+        if (!bind_data.render_options.empty()) {
+            samples[parts[0]] = DecodeSheetCells(body);
+            continue;
+        }
+        auto sampled = DecodeSheetRanges(body, parts.size());
+        for (idx_t i = 0; i < parts.size(); i++) {
+            samples[parts[i]] = std::move(sampled[i]);
+        }
+    }
+    return samples;
+}
 
-ReadSheetBindData::ReadSheetBindData(string spreadsheet_id, string token, bool header, string sheet_name) 
-    : spreadsheet_id(spreadsheet_id), token(token), finished(false), row_index(0), header(header), sheet_name(sheet_name) {
-    response = call_sheets_api(spreadsheet_id, token, sheet_name, HttpMethod::GET);
+// Splits the data rows of every sheet into slices of at most batch_rows rows, and packs consecutive slices of the
+// same spreadsheet into windows of at most batch_rows rows, so that a read of many small sheets takes few requests
+static vector<SheetWindow> PlanWindows(const ReadSheetBindData &bind_data) {
+    // Without an explicit batch_rows, windows grow as the request budget of the user runs out
+    idx_t batch_rows = bind_data.batch_rows;
+    if (bind_data.adaptive_batch_rows) {
+        batch_rows *= get_batch_scale(bind_data.token, bind_data.request_settings, HttpMethod::GET);
+    }
+    vector<SheetWindow> windows;
+    SheetWindow window;
+    idx_t window_rows = 0;
+    for (idx_t p = 0; p < bind_data.parts.size(); p++) {
+        auto &part = bind_data.parts[p];
+        if (bind_data.first_column > part.last_column) {
+            continue;
+        }
+        for (idx_t first_row = bind_data.FirstDataRow(); first_row <= part.last_row; first_row += batch_rows) {
+            idx_t last_row = MinValue<idx_t>(first_row + batch_rows - 1, part.last_row);
+            idx_t rows = last_row - first_row + 1;
+            if (!window.slices.empty() && (window_rows + rows > batch_rows ||
+                                           bind_data.parts[window.slices[0].part].spreadsheet_id != part.spreadsheet_id)) {
+                window.batch_index = windows.size();
+                windows.push_back(std::move(window));
+                window = SheetWindow();
+                window_rows = 0;
+            }
+            window.slices.push_back(SheetSlice {p, first_row, last_row});
+            window_rows += rows;
+        }
+    }
+    if (!window.slices.empty()) {
+        window.batch_index = windows.size();
+        windows.push_back(std::move(window));
+    }
+    return windows;
 }
 
-bool IsValidNumber(const string& value) {
-    // Skip empty strings
-    if (value.empty()) {
+// The ranges holding the projected columns of every slice of the window, e.g. Sheet1!A2:C5001, and where their cells
+// are decoded into. Columns past the end of the grid of a sheet are never requested, they are NULL.
+static vector<string> GetWindowRanges(const ReadSheetBindData &bind_data, const ReadSheetGlobalState &gstate,
+                                      const SheetWindow &window, SheetColumnMapping &mapping) {
+    mapping = gstate.mapping;
+    vector<string> ranges;
+    for (idx_t s = 0; s < window.slices.size(); s++) {
+        auto &slice = window.slices[s];
+        auto &part = bind_data.parts[slice.part];
+        for (auto &columns : gstate.column_ranges) {
+            idx_t first_column = bind_data.first_column + columns.first;
+            if (first_column > part.last_column) {
+                break;
+            }
+            idx_t last_column = MinValue<idx_t>(bind_data.first_column + columns.second, part.last_column);
+            ranges.push_back(GetSheetRange(part, first_column, last_column, slice.first_row, slice.last_row));
+            mapping.range_columns.push_back(columns.first);
+            mapping.range_widths.push_back(last_column - first_column + 1);
+            mapping.range_parts.push_back(s);
+            mapping.range_first_rows.push_back(slice.first_row);
+            mapping.range_first_columns.push_back(first_column);
+        }
+        mapping.part_sheets.push_back(part.title);
+        vector<string> constants;
+        for (auto source : gstate.constant_sources) {
+            constants.push_back(source == bind_data.sheet_name_column ? part.title : part.source);
+        }
+        mapping.part_constants.push_back(std::move(constants));
+    }
+    return ranges;
+}
+
+// Hands out the next window. Returns false once every window is handed out.
+static bool ClaimWindow(ReadSheetGlobalState &gstate, SheetWindow &window) {
+    lock_guard<mutex> guard(gstate.lock);
+    if (gstate.next_window >= gstate.windows.size()) {
         return false;
     }
-    
+    window = gstate.windows[gstate.next_window++];
+    return true;
+}
+
+// The key of a window in the memory cache: the projected columns, and the ranges requested
+static string GetWindowKey(const ReadSheetGlobalState &gstate, const vector<string> &ranges) {
+    string key = gstate.cached_columns;
+    for (auto &range : ranges) {
+        key += "\n" + range;
+    }
+    return key;
+}
+
+// Starts downloading a window in the background, and shares the response with the threads decoding the windows after
+// it. A request that cannot be started fails the response, so that those threads do not wait for it. A window cached
+// in memory is not requested, its rows are taken from the cache and the response is left invalid.
+static std::shared_future<HttpResponse> RequestWindow(ClientContext &context, const ReadSheetBindData &bind_data,
+                                                      ReadSheetGlobalState &gstate, const SheetWindow &window,
+                                                      SheetColumnMapping &mapping) {
+    auto &progress = gstate.progress[window.batch_index];
+    std::shared_future<HttpResponse> response;
     try {
-        // Try to parse as double
-        size_t processed;
-        std::stod(value, &processed);
-        // Ensure the entire string was processed
-        return processed == value.length();
+        auto ranges = GetWindowRanges(bind_data, gstate, window, mapping);
+        auto &spreadsheet_id = bind_data.parts[window.slices[0].part].spreadsheet_id;
+        shared_ptr<CachedWindow> cached;
+        if (!bind_data.cache_key.empty()) {
+            auto window_key = GetWindowKey(gstate, ranges);
+            cached = SheetMemoryCache::Get(context).LookupWindow(spreadsheet_id, bind_data.cache_key, window_key);
+            lock_guard<mutex> guard(gstate.lock);
+            progress.window_key = std::move(window_key);
+            if (cached) {
+                progress.slice_rows = cached->slice_rows;
+                progress.cached = cached;
+                progress.done = true;
+            }
+        }
+        if (!cached) {
+            response = RequestRanges(bind_data, spreadsheet_id, ranges).share();
+        }
     } catch (...) {
-        return false;
+        std::promise<HttpResponse> failed;
+        failed.set_exception(std::current_exception());
+        response = failed.get_future().share();
+    }
+    {
+        lock_guard<mutex> guard(gstate.lock);
+        progress.response = response;
     }
+    gstate.progress_changed.notify_all();
+    return response;
 }
 
-void ReadSheetFunction(ClientContext &context, TableFunctionInput &data_p, DataChunk &output) {
-    auto &bind_data = const_cast<ReadSheetBindData&>(data_p.bind_data->Cast<ReadSheetBindData>());
+// The rows of every slice of a window holding values. Waits for the thread decoding the window, or counts them in its
+// response if no thread is decoding it yet, e.g. because the thread that claimed it is still scanning its previous
+// window. Only waits for earlier windows, so threads never wait for each other in a cycle.
+static const vector<idx_t> &GetSliceRows(const ReadSheetBindData &bind_data, ReadSheetGlobalState &gstate,
+                                         idx_t window_index, unique_lock<mutex> &guard) {
+    auto &progress = gstate.progress[window_index];
+    while (!progress.done) {
+        if (progress.decoding || !progress.response.valid()) {
+            gstate.progress_changed.wait(guard);
+            continue;
+        }
+        auto response = progress.response;
+        auto &window = gstate.windows[window_index];
+        guard.unlock();
+        SheetColumnMapping mapping;
+        GetWindowRanges(bind_data, gstate, window, mapping);
+        auto slice_rows = DecodeSheetExtents(GetResponseBody(response), mapping);
+        slice_rows.resize(window.slices.size(), 0);
+        guard.lock();
+        if (!progress.done) {
+            progress.slice_rows = std::move(slice_rows);
+            progress.done = true;
+            gstate.progress_changed.notify_all();
+        }
+    }
+    return progress.slice_rows;
+}
+
+// The sheet row below the last row holding a value above a slice, or the first data row if there is none. The slices
+// of a sheet are the last slice of a window and the first slice of the next one.
+static idx_t GetPreviousDataEnd(const ReadSheetBindData &bind_data, ReadSheetGlobalState &gstate, idx_t window_index,
+                                idx_t slice_index, unique_lock<mutex> &guard) {
+    idx_t first_data_row = bind_data.FirstDataRow();
+    idx_t first_row = gstate.windows[window_index].slices[slice_index].first_row;
+    while (first_row > first_data_row) {
+        window_index--;
+        auto &previous = gstate.windows[window_index];
+        slice_index = previous.slices.size() - 1;
+        D_ASSERT(previous.slices[slice_index].part == gstate.windows[window_index + 1].slices[0].part);
+        first_row = previous.slices[slice_index].first_row;
+        idx_t rows = GetSliceRows(bind_data, gstate, window_index, guard)[slice_index];
+        if (rows > 0) {
+            return first_row + rows;
+        }
+    }
+    return first_data_row;
+}
 
-    if (bind_data.finished) {
+// For the last slice of every sheet of a projected read, the rows below its last row holding a value in the requested
+// columns up to the last row holding a value in any column, so that the read ends at the same row as a read of every
+// column. They are counted with one request of every column of the rows below.
+static vector<idx_t> GetTrailingRows(const ReadSheetBindData &bind_data, const SheetWindow &window,
+                                     const SheetColumnMapping &mapping, const string &response,
+                                     const vector<idx_t> &previous_ends) {
+    vector<idx_t> trailing_rows(window.slices.size(), 0);
+    vector<idx_t> slice_rows;
+    for (idx_t s = 0; s < window.slices.size(); s++) {
+        auto &slice = window.slices[s];
+        auto &part = bind_data.parts[slice.part];
+        if (slice.last_row != part.last_row) {
+            continue;
+        }
+        if (slice_rows.empty()) {
+            slice_rows = DecodeSheetExtents(response, mapping);
+            slice_rows.resize(window.slices.size(), 0);
+        }
+        idx_t end = slice_rows[s] > 0 ? slice.first_row + slice_rows[s] : previous_ends[s];
+        if (end > part.last_row) {
+            continue;
+        }
+        auto range = GetSheetRange(part, bind_data.first_column, part.last_column, end, part.last_row);
+        auto request = RequestRanges(bind_data, part.spreadsheet_id, {range});
+        SheetColumnMapping rows_below;
+        rows_below.range_columns.push_back(0);
+        rows_below.range_first_rows.push_back(end);
+        auto extents = DecodeSheetExtents(GetResponseBody(request), rows_below);
+        trailing_rows[s] = extents.empty() ? 0 : extents[0];
+    }
+    return trailing_rows;
+}
+
+// Decodes a window into the collection. The rows of each slice start with the empty rows its sheet ended in above
+// it, which the API leaves out of the earlier slices, so a slice holding values waits until the earlier slices of its
+// sheet are known. Slices without any value add no rows, the rows of a sheet end at its last row holding a value.
+static void DecodeWindow(ClientContext &context, const ReadSheetBindData &bind_data, ReadSheetGlobalState &gstate,
+                         const SheetWindow &window, SheetColumnMapping &mapping,
+                         const std::shared_future<HttpResponse> &response, ColumnDataCollection &collection) {
+    auto &progress = gstate.progress[window.batch_index];
+    unique_lock<mutex> guard(gstate.lock);
+    progress.decoding = true;
+    try {
+        vector<idx_t> previous_ends;
+        for (idx_t s = 0; s < window.slices.size(); s++) {
+            previous_ends.push_back(GetPreviousDataEnd(bind_data, gstate, window.batch_index, s, guard));
+            mapping.part_leading_rows.push_back(window.slices[s].first_row - previous_ends.back());
+        }
+        guard.unlock();
+        auto &body = GetResponseBody(response);
+        if (!gstate.all_columns) {
+            mapping.part_trailing_rows = GetTrailingRows(bind_data, window, mapping, body, previous_ends);
+        }
+        vector<idx_t> slice_rows;
+        DecodeSheetValues(context, body, mapping, collection, &slice_rows);
+        slice_rows.resize(window.slices.size(), 0);
+        guard.lock();
+        progress.slice_rows = std::move(slice_rows);
+        progress.done = true;
+    } catch (...) {
+        if (!guard.owns_lock()) {
+            guard.lock();
+        }
+        // The windows after this one count the rows of its response themselves
+        progress.decoding = false;
+        gstate.progress_changed.notify_all();
+        throw;
+    }
+    progress.decoding = false;
+    // The windows after this one only need its slice rows
+    progress.response = std::shared_future<HttpResponse>();
+    gstate.progress_changed.notify_all();
+}
+
+// Claims the next window for this thread and starts downloading it in the background
+static void StartNextWindow(ClientContext &context, const ReadSheetBindData &bind_data, ReadSheetGlobalState &gstate,
+                            ReadSheetLocalState &lstate) {
+    lstate.has_next = ClaimWindow(gstate, lstate.next);
+    if (!lstate.has_next) {
         return;
     }
+    lstate.next_window = RequestWindow(context, bind_data, gstate, lstate.next, lstate.next_mapping);
+}
 
-    json cleanJson = parseJson(bind_data.response);
-    SheetData sheet_data = getSheetData(cleanJson);
-
-    idx_t row_count = 0;
-    idx_t column_count = output.ColumnCount();
-
-    // Adjust starting index based on whether we're using the header
-    idx_t start_index = bind_data.header ? bind_data.row_index + 1 : bind_data.row_index;
-
-    // Determine column types
-    vector<LogicalType> column_types(column_count, LogicalType::VARCHAR);
-    if (start_index < sheet_data.values.size()) {
-        const auto& first_data_row = sheet_data.values[start_index];
-        for (idx_t col = 0; col < column_count && col < first_data_row.size(); col++) {
-            const string& value = first_data_row[col];
-            if (value == "true" || value == "false") {
-                column_types[col] = LogicalType::BOOLEAN;
-            } else if (IsValidNumber(value)) {
-                column_types[col] = LogicalType::DOUBLE;
-            }
-        }
-    }
-
-    for (idx_t i = start_index; i < sheet_data.values.size() && row_count < STANDARD_VECTOR_SIZE; i++) {
-        const auto& row = sheet_data.values[i];
-        for (idx_t col = 0; col < column_count; col++) {
-            if (col < row.size()) {
-                const string& value = row[col];
-                switch (column_types[col].id()) {
-                    case LogicalTypeId::BOOLEAN:
-                        if (value.empty()) {
-                            output.SetValue(col, row_count, Value(LogicalType::BOOLEAN));
-                        } else {
-                            output.SetValue(col, row_count, Value(value).DefaultCastAs(LogicalType::BOOLEAN));
-                        }
-                        break;
-                    case LogicalTypeId::DOUBLE:
-                        if (value.empty()) {
-                            output.SetValue(col, row_count, Value(LogicalType::DOUBLE));
-                        } else {
-                            output.SetValue(col, row_count, Value(value).DefaultCastAs(LogicalType::DOUBLE));
-                        }
-                        break;
-                    default:
-                        output.SetValue(col, row_count, Value(value));
-                        break;
-                }
-            } else {
-                output.SetValue(col, row_count, Value(nullptr));
+// The types a column can be sniffed as, from the narrowest to the widest. VARCHAR holds any column.
+static const LogicalTypeId SNIFFED_TYPES[] = {LogicalTypeId::BOOLEAN, LogicalTypeId::BIGINT, LogicalTypeId::DOUBLE,
+                                              LogicalTypeId::DATE, LogicalTypeId::TIMESTAMP};
+static constexpr idx_t SNIFFED_TYPE_COUNT = sizeof(SNIFFED_TYPES) / sizeof(SNIFFED_TYPES[0]);
+
+// Whether the cell parses as the type, with the same parsers the cells are decoded with
+static bool CellMatchesType(const string &cell, LogicalTypeId type) {
+    string_t input(cell);
+    switch (type) {
+    case LogicalTypeId::BOOLEAN:
+        // Only the TRUE and FALSE of checkboxes, 0 and 1 are numbers
+        return StringUtil::CIEquals(cell, "true") || StringUtil::CIEquals(cell, "false");
+    case LogicalTypeId::BIGINT: {
+        int64_t result;
+        return TryCast::Operation<string_t, int64_t>(input, result, true);
+    }
+    case LogicalTypeId::DOUBLE: {
+        double result;
+        return TryCast::Operation<string_t, double>(input, result, true);
+    }
+    case LogicalTypeId::DATE: {
+        date_t result;
+        return TryCast::Operation<string_t, date_t>(input, result, true);
+    }
+    case LogicalTypeId::TIMESTAMP: {
+        timestamp_t result;
+        return TryCast::Operation<string_t, timestamp_t>(input, result, true);
+    }
+    default:
+        return false;
+    }
+}
+
+// Picks the narrowest type every non-empty sampled cell of the column parses as, columns without any value are VARCHAR
+static LogicalType SniffColumnType(const vector<vector<string>> &rows, idx_t first_row, idx_t col) {
+    bool candidates[SNIFFED_TYPE_COUNT];
+    std::fill(candidates, candidates + SNIFFED_TYPE_COUNT, true);
+    bool has_value = false;
+    for (idx_t r = first_row; r < rows.size(); r++) {
+        if (col >= rows[r].size() || rows[r][col].empty()) {
+            continue;
+        }
+        has_value = true;
+        for (idx_t t = 0; t < SNIFFED_TYPE_COUNT; t++) {
+            candidates[t] = candidates[t] && CellMatchesType(rows[r][col], SNIFFED_TYPES[t]);
+        }
+    }
+    if (has_value) {
+        for (idx_t t = 0; t < SNIFFED_TYPE_COUNT; t++) {
+            if (candidates[t]) {
+                return LogicalType(SNIFFED_TYPES[t]);
             }
         }
-        row_count++;
     }
+    return LogicalType::VARCHAR;
+}
+
+// Sets up the columns requested per slice, and where their cells are decoded into, for the columns read. Only the
+// projected columns are requested and decoded. The sheet_name and filename columns are filled in per slice.
+static void InitializeColumns(const ReadSheetBindData &bind_data, const vector<column_t> &column_ids,
+                              ReadSheetGlobalState &gstate) {
+    idx_t sheet_columns = bind_data.column_count;
+    vector<bool> requested(sheet_columns, false);
+    gstate.mapping.output_columns.resize(sheet_columns, DConstants::INVALID_INDEX);
+    for (idx_t i = 0; i < column_ids.size(); i++) {
+        auto column_id = column_ids[i];
+        gstate.cached_columns += (i == 0 ? "" : ",") + std::to_string(column_id);
+        if (column_id == COLUMN_IDENTIFIER_ROW_ID) {
+            gstate.types.push_back(LogicalType::ROW_TYPE);
+            continue;
+        }
+        gstate.types.push_back(bind_data.types[column_id]);
+        if (column_id < sheet_columns) {
+            gstate.mapping.output_columns[column_id] = i;
+            requested[column_id] = true;
+        } else {
+            gstate.mapping.constant_columns.push_back(i);
+            gstate.constant_sources.push_back(column_id);
+        }
+    }
+    gstate.all_columns = true;
+    for (idx_t col = 0; col < sheet_columns; col++) {
+        gstate.all_columns = gstate.all_columns && requested[col];
+    }
+    if (std::find(requested.begin(), requested.end(), true) == requested.end()) {
+        // No column is read (e.g. count(*)), request all of them so that every row is counted
+        requested.assign(sheet_columns, true);
+        gstate.all_columns = true;
+    }
+
+    // Adjacent columns are requested as a single range
+    for (idx_t col = 0; col < sheet_columns; col++) {
+        if (!requested[col]) {
+            continue;
+        }
+        idx_t end = col;
+        while (end + 1 < sheet_columns && requested[end + 1]) {
+            end++;
+        }
+        gstate.column_ranges.emplace_back(col, end);
+        col = end;
+    }
+}
+
+// Downloads and decodes every column of every row read. As many windows as there are threads are in flight while
+// the earliest one is decoded. Reads cached on disk are read whole at bind time, so that the other binds of the same
+// read, e.g. the other side of a self join, are served from the cache.
+static shared_ptr<ColumnDataCollection> ReadAllRows(ClientContext &context, const ReadSheetBindData &bind_data) {
+    ReadSheetGlobalState gstate(1);
+    vector<column_t> column_ids;
+    for (idx_t col = 0; col < bind_data.types.size(); col++) {
+        column_ids.push_back(col);
+    }
+    InitializeColumns(bind_data, column_ids, gstate);
+    gstate.windows = PlanWindows(bind_data);
+    gstate.progress.resize(gstate.windows.size());
+
+    struct PendingWindow {
+        SheetWindow window;
+        SheetColumnMapping mapping;
+        std::shared_future<HttpResponse> response;
+    };
+    std::deque<PendingWindow> pending;
+    auto result = make_shared_ptr<ColumnDataCollection>(context, gstate.types);
+    idx_t parallelism = MaxValue<idx_t>(NumericCast<idx_t>(TaskScheduler::GetScheduler(context).NumberOfThreads()), 1);
+    while (true) {
+        PendingWindow next;
+        while (pending.size() < parallelism && ClaimWindow(gstate, next.window)) {
+            next.response = RequestWindow(context, bind_data, gstate, next.window, next.mapping);
+            pending.push_back(std::move(next));
+        }
+        if (pending.empty()) {
+            break;
+        }
+        // Windows are decoded in order, windows past the data of their sheets come back empty
+        auto window = std::move(pending.front());
+        pending.pop_front();
+        DecodeWindow(context, bind_data, gstate, window.window, window.mapping, window.response, *result);
+    }
+    return result;
+}
+
+// Sniffs the column names from the header of the first sheet and the column types from a sample of the data rows of
+// every sheet
+static void SniffSchema(const ReadSheetBindData &bind_data, const vector<idx_t> &sample_last_rows, vector<string> &names,
+                        vector<LogicalType> &types) {
+    auto samples = SampleSheets(bind_data, sample_last_rows);
+    vector<vector<string>> rows;
+    idx_t start_index = bind_data.header ? 1 : 0;
+    for (auto &sample : samples) {
+        if (bind_data.header && rows.empty()) {
+            rows.push_back(sample.empty() ? vector<string>() : std::move(sample[0]));
+        }
+        for (idx_t r = start_index; r < sample.size(); r++) {
+            rows.push_back(std::move(sample[r]));
+        }
+    }
+
+    if (start_index < rows.size()) {
+        // The widest of the header and the sampled rows gives the number of columns
+        idx_t column_count = 0;
+        for (auto &row : rows) {
+            column_count = MaxValue<idx_t>(column_count, row.size());
+        }
+        for (idx_t i = 0; i < column_count; i++) {
+            bool has_name = bind_data.header && i < rows[0].size() && !rows[0][i].empty();
+            names.push_back(has_name ? rows[0][i] : "column" + std::to_string(i + 1));
+            types.push_back(SniffColumnType(rows, start_index, i));
+        }
+    }
+}
+
+unique_ptr<GlobalTableFunctionState> ReadSheetInitGlobal(ClientContext &context, TableFunctionInitInput &input) {
+    auto &bind_data = input.bind_data->Cast<ReadSheetBindData>();
+    if (bind_data.cached_rows) {
+        // The rows are cached, a single thread scans them
+        auto result = make_uniq<ReadSheetGlobalState>(1);
+        result->whole_rows = true;
+        result->column_ids = input.column_ids;
+        result->types = bind_data.types;
+        return std::move(result);
+    }
+
+    // Each thread fetches its own windows, there is no point in more threads than windows
+    auto windows = PlanWindows(bind_data);
+    auto result = make_uniq<ReadSheetGlobalState>(MaxValue<idx_t>(windows.size(), 1));
+    result->windows = std::move(windows);
+    result->progress.resize(result->windows.size());
+    InitializeColumns(bind_data, input.column_ids, *result);
+    return std::move(result);
+}
+
+unique_ptr<LocalTableFunctionState> ReadSheetInitLocal(ExecutionContext &context, TableFunctionInitInput &input,
+                                                       GlobalTableFunctionState *global_state) {
+    auto &bind_data = input.bind_data->Cast<ReadSheetBindData>();
+    auto &gstate = global_state->Cast<ReadSheetGlobalState>();
+    auto result = make_uniq<ReadSheetLocalState>();
+    if (gstate.whole_rows) {
+        result->rows.Initialize(context.client, bind_data.types);
+    }
+    if (bind_data.cached_rows) {
+        result->collection = bind_data.cached_rows;
+        result->collection->InitializeScan(result->scan_state);
+        return std::move(result);
+    }
+    result->collection = make_shared_ptr<ColumnDataCollection>(context.client, gstate.types);
+    result->collection->InitializeScan(result->scan_state);
+    StartNextWindow(context.client, bind_data, gstate, *result);
+    return std::move(result);
+}
+
+// Scans the current window into output, moving on to the next window once it is exhausted
+static void ScanWindows(ClientContext &context, const ReadSheetBindData &bind_data, ReadSheetGlobalState &gstate,
+                        ReadSheetLocalState &lstate, DataChunk &output) {
+    while (!lstate.collection->Scan(lstate.scan_state, output)) {
+        if (!lstate.has_next) {
+            return;
+        }
+
+        // Move on to the window downloaded in the background
+        auto response = std::move(lstate.next_window);
+        auto window = std::move(lstate.next);
+        auto mapping = std::move(lstate.next_mapping);
+        lstate.batch_index = window.batch_index;
+        shared_ptr<CachedWindow> cached;
+        string window_key;
+        {
+            lock_guard<mutex> guard(gstate.lock);
+            cached = gstate.progress[window.batch_index].cached;
+            window_key = gstate.progress[window.batch_index].window_key;
+        }
+        if (cached) {
+            // The cached rows are shared with the cache and the other scans, which only read them
+            lstate.collection = cached->rows;
+        } else if (bind_data.cache_key.empty()) {
+            lstate.collection->Reset();
+            DecodeWindow(context, bind_data, gstate, window, mapping, response, *lstate.collection);
+        } else {
+            // The rows are handed to the cache once decoded, so each window is decoded into a collection of its own
+            lstate.collection = make_shared_ptr<ColumnDataCollection>(context, gstate.types);
+            DecodeWindow(context, bind_data, gstate, window, mapping, response, *lstate.collection);
+            auto decoded = make_shared_ptr<CachedWindow>();
+            decoded->rows = lstate.collection;
+            {
+                lock_guard<mutex> guard(gstate.lock);
+                decoded->slice_rows = gstate.progress[window.batch_index].slice_rows;
+            }
+            auto &spreadsheet_id = bind_data.parts[window.slices[0].part].spreadsheet_id;
+            SheetMemoryCache::Get(context).StoreWindow(context, spreadsheet_id, bind_data.cache_key, window_key,
+                                                       std::move(decoded));
+        }
+        StartNextWindow(context, bind_data, gstate, lstate);
+        lstate.collection->InitializeScan(lstate.scan_state);
+    }
+}
+
+void ReadSheetFunction(ClientContext &context, TableFunctionInput &data_p, DataChunk &output) {
+    auto &bind_data = data_p.bind_data->Cast<ReadSheetBindData>();
+    auto &gstate = data_p.global_state->Cast<ReadSheetGlobalState>();
+    auto &lstate = data_p.local_state->Cast<ReadSheetLocalState>();
+    if (!gstate.whole_rows) {
+        ScanWindows(context, bind_data, gstate, lstate, output);
+        return;
+    }
+
+    lstate.rows.Reset();
+    ScanWindows(context, bind_data, gstate, lstate, lstate.rows);
+    for (idx_t i = 0; i < gstate.column_ids.size(); i++) {
+        auto column_id = gstate.column_ids[i];
+        if (column_id == COLUMN_IDENTIFIER_ROW_ID) {
+            output.data[i].SetVectorType(VectorType::CONSTANT_VECTOR);
+            ConstantVector::SetNull(output.data[i], true);
+        } else {
+            output.data[i].Reference(lstate.rows.data[column_id]);
+        }
+    }
+    output.SetCardinality(lstate.rows.size());
+}
 
-    bind_data.row_index += row_count;
-    bind_data.finished = (bind_data.row_index >= (sheet_data.values.size() - (bind_data.header ? 1 : 0)));
+idx_t ReadSheetGetBatchIndex(ClientContext &context, const FunctionData *bind_data_p,
+                             LocalTableFunctionState *local_state, GlobalTableFunctionState *global_state) {
+    return local_state->Cast<ReadSheetLocalState>().batch_index;
+}
 
-    output.SetCardinality(row_count);
+// The values of a parameter taking a string or a list of strings
+static vector<string> GetStringList(const Value &value, const string &parameter) {
+    vector<string> result;
+    if (value.type().id() == LogicalTypeId::LIST) {
+        for (auto &child : ListValue::GetChildren(value)) {
+            if (child.IsNull()) {
+                throw InvalidInputException("Invalid value for '%s' parameter. Expected a string or a list of strings.", parameter);
+            }
+            result.push_back(child.ToString());
+        }
+    } else if (value.type().id() == LogicalTypeId::VARCHAR && !value.IsNull()) {
+        result.push_back(StringValue::Get(value));
+    } else {
+        throw InvalidInputException("Invalid value for '%s' parameter. Expected a string or a list of strings.", parameter);
+    }
+    if (result.empty()) {
+        throw InvalidInputException("Invalid value for '%s' parameter. Expected at least one value.", parameter);
+    }
+    return result;
 }
 
 unique_ptr<FunctionData> ReadSheetBind(ClientContext &context, TableFunctionBindInput &input,
                                               vector<LogicalType> &return_types, vector<string> &names) {
-    auto sheet_input = input.inputs[0].GetValue<string>();
+    // One spreadsheet, or a list of them, each given as a URL or an ID
+    auto sources = GetStringList(input.inputs[0], "spreadsheet");
     
     // Default values
     bool header = true;
     string sheet_name = "Sheet1";
-
-    // Extract the spreadsheet ID from the input (URL or ID)
-    std::string spreadsheet_id = extract_spreadsheet_id(sheet_input);
+    idx_t batch_rows = ReadSheetBindData::DEFAULT_BATCH_ROWS;
+    bool adaptive_batch_rows = true;
+    SheetRange range;
+    idx_t skip = 0;
+    idx_t max_rows = DConstants::INVALID_INDEX;
+    idx_t sample_size = ReadSheetBindData::DEFAULT_SAMPLE_SIZE;
+    string render_options;
+    vector<string> column_names;
+    vector<LogicalType> column_types;
+    vector<string> sheet_names;
+    bool all_sheets = false;
+    bool sheet_name_column = false;
+    bool filename_column = false;
 
     // Use the SecretManager to get the token
     auto &secret_manager = SecretManager::Get(context);
@@ -136,11 +797,8 @@ unique_ptr<FunctionData> ReadSheetBind(ClientContext &context, TableFunctionBind
 
     std::string token = token_value.ToString();
 
-    // Get sheet name from URL
-    std::string sheet_id = extract_sheet_id(sheet_input);
-    sheet_name = get_sheet_name_from_id(spreadsheet_id, sheet_id, token);
-
     // Parse named parameters
+    bool has_sheet_name = false;
     for (auto &kv : input.named_parameters) {
         if (kv.first == "header") {
             try {
@@ -150,38 +808,226 @@ unique_ptr<FunctionData> ReadSheetBind(ClientContext &context, TableFunctionBind
             }
         } else if (kv.first == "sheet") {
             sheet_name = kv.second.GetValue<string>();
+            has_sheet_name = true;
+        } else if (kv.first == "sheets") {
+            // '*' reads every sheet of the spreadsheets
+            sheet_names = GetStringList(kv.second, "sheets");
+            all_sheets = std::find(sheet_names.begin(), sheet_names.end(), "*") != sheet_names.end();
+        } else if (kv.first == "sheet_name") {
+            sheet_name_column = kv.second.GetValue<bool>();
+        } else if (kv.first == "filename") {
+            filename_column = kv.second.GetValue<bool>();
+        } else if (kv.first == "batch_rows") {
+            int64_t value = kv.second.GetValue<int64_t>();
+            if (value <= 0) {
+                throw InvalidInputException("Invalid value for 'batch_rows' parameter. Expected a positive integer.");
+            }
+            batch_rows = value;
+            adaptive_batch_rows = false;
+        } else if (kv.first == "range") {
+            range = parse_sheet_range(kv.second.GetValue<string>());
+        } else if (kv.first == "skip") {
+            int64_t value = kv.second.GetValue<int64_t>();
+            if (value < 0) {
+                throw InvalidInputException("Invalid value for 'skip' parameter. Expected a non-negative integer.");
+            }
+            skip = value;
+        } else if (kv.first == "max_rows") {
+            int64_t value = kv.second.GetValue<int64_t>();
+            if (value < 0) {
+                throw InvalidInputException("Invalid value for 'max_rows' parameter. Expected a non-negative integer.");
+            }
+            max_rows = value;
+        } else if (kv.first == "sample_size") {
+            int64_t value = kv.second.GetValue<int64_t>();
+            if (value == -1) {
+                // Sample every row
+                sample_size = DConstants::INVALID_INDEX;
+            } else if (value <= 0) {
+                throw InvalidInputException("Invalid value for 'sample_size' parameter. Expected a positive integer or -1.");
+            } else {
+                sample_size = value;
+            }
+        } else if (kv.first == "value_render_option") {
+            auto value = kv.second.GetValue<string>();
+            if (StringUtil::CIEquals(value, "UNFORMATTED_VALUE")) {
+                // Dates and times are read as serial numbers, and converted to DATE and TIMESTAMP columns
+                render_options = "&valueRenderOption=UNFORMATTED_VALUE&dateTimeRenderOption=SERIAL_NUMBER";
+            } else if (!StringUtil::CIEquals(value, "FORMATTED_VALUE")) {
+                throw InvalidInputException("Invalid value for 'value_render_option' parameter. Expected 'FORMATTED_VALUE' or 'UNFORMATTED_VALUE'.");
+            }
+        } else if (kv.first == "columns") {
+            if (kv.second.type().id() != LogicalTypeId::STRUCT) {
+                throw InvalidInputException("Invalid value for 'columns' parameter. Expected a struct of column names to types, e.g. {'name': 'VARCHAR'}.");
+            }
+            auto &child_types = StructType::GetChildTypes(kv.second.type());
+            auto &children = StructValue::GetChildren(kv.second);
+            for (idx_t i = 0; i < children.size(); i++) {
+                if (children[i].type().id() != LogicalTypeId::VARCHAR) {
+                    throw InvalidInputException("Invalid value for 'columns' parameter. Column types must be given as strings.");
+                }
+                column_names.push_back(child_types[i].first);
+                column_types.push_back(TransformStringToLogicalType(StringValue::Get(children[i]), context));
+            }
+            if (column_names.empty()) {
+                throw InvalidInputException("Invalid value for 'columns' parameter. At least one column is required.");
+            }
         }
     }
 
-    std::string encoded_sheet_name = url_encode(sheet_name);
-    
-    auto bind_data = make_uniq<ReadSheetBindData>(spreadsheet_id, token, header, encoded_sheet_name);
-
-    json cleanJson = parseJson(bind_data->response);
-    SheetData sheet_data = getSheetData(cleanJson);
-
-    if (!sheet_data.values.empty()) {
-        idx_t start_index = header ? 1 : 0;
-        if (start_index < sheet_data.values.size()) {
-            const auto& first_data_row = sheet_data.values[start_index];
-            for (size_t i = 0; i < first_data_row.size(); i++) {
-                string column_name = header ? sheet_data.values[0][i] : "column" + std::to_string(i + 1);
-                names.push_back(column_name);
-                
-                const string& value = first_data_row[i];
-                if (value == "true" || value == "false") {
-                    return_types.push_back(LogicalType::BOOLEAN);
-                } else if (IsValidNumber(value)) {
-                    return_types.push_back(LogicalType::DOUBLE);
-                } else {
-                    return_types.push_back(LogicalType::VARCHAR);
-                }
+    // A range naming a sheet takes the place of the sheet parameter
+    if (!range.sheet_name.empty()) {
+        sheet_name = range.sheet_name;
+        has_sheet_name = true;
+    }
+    if (has_sheet_name && !sheet_names.empty()) {
+        throw InvalidInputException("The 'sheets' parameter cannot be combined with 'sheet' or a range naming a sheet.");
+    }
+
+    auto bind_data = make_uniq<ReadSheetBindData>(token, header);
+    bind_data->request_settings = GetRequestSettings(context);
+    bind_data->batch_rows = batch_rows;
+    bind_data->adaptive_batch_rows = adaptive_batch_rows;
+    bind_data->render_options = render_options;
+    bind_data->first_row = (range.first_row != 0 ? range.first_row : 1) + skip;
+    bind_data->first_column = range.first_column != 0 ? range.first_column - 1 : 0;
+
+    // Get the sheets of every spreadsheet: those of the sheets parameter, the sheet parameter, or the sheet ID in
+    // the URL
+    auto &metadata_cache = SpreadsheetMetadataCache::Get(context);
+    vector<idx_t> sample_last_rows;
+    for (auto &source : sources) {
+        auto spreadsheet_id = extract_spreadsheet_id(source);
+        vector<SheetProperties> sheets;
+        if (all_sheets) {
+            sheets = metadata_cache.GetSheets(context, spreadsheet_id, token);
+        } else if (!sheet_names.empty()) {
+            for (auto &name : sheet_names) {
+                sheets.push_back(metadata_cache.GetSheetByName(context, spreadsheet_id, name, token));
             }
+        } else if (has_sheet_name) {
+            sheets.push_back(metadata_cache.GetSheetByName(context, spreadsheet_id, sheet_name, token));
+        } else {
+            sheets.push_back(metadata_cache.GetSheetById(context, spreadsheet_id, extract_sheet_id(source), token));
+        }
+
+        for (auto &sheet : sheets) {
+            SheetPart part;
+            part.source = source;
+            part.spreadsheet_id = spreadsheet_id;
+            part.title = sheet.title;
+            part.sheet_name = url_encode(quote_sheet_name(sheet.title));
+
+            // Narrow the rows and columns read down to the range, the skipped rows and max_rows. Requests never
+            // reach past the end of the grid, since the API rejects those, so the windows are fixed before the scan.
+            idx_t range_last_row = range.last_row != 0 ? MinValue<idx_t>(range.last_row, sheet.row_count) : sheet.row_count;
+            part.last_row = range_last_row;
+            if (max_rows != DConstants::INVALID_INDEX) {
+                part.last_row = MinValue<idx_t>(part.last_row, bind_data->FirstDataRow() + max_rows - 1);
+            }
+            part.last_column = sheet.column_count > 0 ? sheet.column_count - 1 : 0;
+            if (range.last_column != 0) {
+                part.last_column = MinValue<idx_t>(part.last_column, range.last_column - 1);
+            }
+            if (!column_names.empty() && bind_data->first_column + column_names.size() - 1 < part.last_column) {
+                part.last_column = bind_data->first_column + column_names.size() - 1;
+            }
+
+            // Sample the rows that are read, but at least the first data row, so that max_rows=0 still has columns
+            idx_t sample_last_row = MaxValue<idx_t>(part.last_row, MinValue<idx_t>(bind_data->FirstDataRow(), range_last_row));
+            if (sample_size != DConstants::INVALID_INDEX) {
+                sample_last_row = MinValue<idx_t>(sample_last_row, bind_data->FirstDataRow() + sample_size - 1);
+            }
+            sample_last_rows.push_back(sample_last_row);
+            bind_data->parts.push_back(std::move(part));
         }
     }
 
-    return bind_data;
+    // Cached reads bring their schema along, and are not sampled. Reads spanning several spreadsheets are not cached,
+    // since they would have to be revalidated against every spreadsheet.
+    auto spreadsheet_id = bind_data->parts[0].spreadsheet_id;
+    bool single_spreadsheet = true;
+    // Reads are only served to the user of the token they were read with
+    string key = get_token_key(token) + "\n";
+    string cached_sheets;
+    for (auto &part : bind_data->parts) {
+        single_spreadsheet = single_spreadsheet && part.spreadsheet_id == spreadsheet_id;
+        key += part.title + ":" + std::to_string(part.last_row) + ":" + std::to_string(part.last_column) + "\n";
+        cached_sheets += (cached_sheets.empty() ? "" : ", ") + part.title;
+    }
+    key += std::to_string(bind_data->first_row) + "\n" + std::to_string(bind_data->first_column) + "\n" +
+           std::to_string(header) + "\n" + render_options + "\n" + std::to_string(sample_size) + "\n" +
+           std::to_string(sheet_name_column) + std::to_string(filename_column);
+    for (idx_t i = 0; i < column_names.size(); i++) {
+        key += "\n" + column_names[i] + " " + column_types[i].ToString();
+    }
+    // With a cache directory, reads are cached whole on disk. Otherwise their windows are cached in memory as they are
+    // scanned.
+    SheetDiskCache disk_cache(context);
+    bool use_disk_cache = single_spreadsheet && disk_cache.Enabled();
+    auto &memory_cache = SheetMemoryCache::Get(context);
+    bool use_memory_cache = single_spreadsheet && !use_disk_cache && SheetMemoryCache::GetMemoryLimit(context) > 0;
+    string cache_path = use_disk_cache ? disk_cache.GetPath(spreadsheet_id, key) : string();
+    SpreadsheetVersion version(spreadsheet_id, token, bind_data->request_settings);
+    shared_ptr<CachedSheet> cached;
+    if (use_disk_cache) {
+        cached = disk_cache.Load(cache_path, key, version);
+    }
+    bool schema_cached = use_memory_cache && memory_cache.LookupRead(context, spreadsheet_id, key, names, return_types);
+
+    if (cached) {
+        names = cached->names;
+        return_types = cached->types;
+    } else if (schema_cached) {
+        // The schema of the sheet columns was cached by an earlier bind of the read
+    } else if (!column_names.empty()) {
+        // The schema is given by the columns parameter, or sniffed from the header and a sample of the data rows
+        names = column_names;
+        return_types = column_types;
+    } else {
+        SniffSchema(*bind_data, sample_last_rows, names, return_types);
+    }
+    if (!cached) {
+        if (use_memory_cache && !schema_cached && !return_types.empty()) {
+            memory_cache.StoreRead(context, spreadsheet_id, key, cached_sheets, names, return_types);
+        }
+        bind_data->column_count = return_types.size();
+        // The sheet and spreadsheet of each row follow the sheet columns
+        if (sheet_name_column) {
+            bind_data->sheet_name_column = return_types.size();
+            names.push_back("sheet_name");
+            return_types.push_back(LogicalType::VARCHAR);
+        }
+        if (filename_column) {
+            bind_data->filename_column = return_types.size();
+            names.push_back("filename");
+            return_types.push_back(LogicalType::VARCHAR);
+        }
+    }
+    bind_data->types = return_types;
+    if (cached) {
+        bind_data->cached_rows = cached->rows;
+        return std::move(bind_data);
+    }
+    if (use_memory_cache && bind_data->column_count > 0) {
+        bind_data->cache_key = key;
+    }
+
+    if (use_disk_cache && bind_data->column_count > 0) {
+        auto sheet = make_shared_ptr<CachedSheet>();
+        // Reads are revalidated against the Drive version of the spreadsheet once they expire. The version is taken
+        // before the download, a change made while downloading is caught by the next read.
+        sheet->version = version.Get();
+        sheet->read_at = std::chrono::duration_cast<std::chrono::seconds>(
+                             std::chrono::system_clock::now().time_since_epoch()).count();
+        sheet->names = names;
+        sheet->types = return_types;
+        sheet->rows = ReadAllRows(context, *bind_data);
+        disk_cache.Store(cache_path, key, *sheet);
+        bind_data->cached_rows = sheet->rows;
+    }
+
+    return std::move(bind_data);
 }
 
 } // namespace duckdb
-
@@ -1,35 +1,498 @@
 #include "gsheets_requests.hpp"
+#include "gsheets_http.hpp"
+#include "gsheets_utils.hpp"
 #include "duckdb/common/exception.hpp"
+#include "duckdb/common/string_util.hpp"
+#include "duckdb/main/client_context.hpp"
+#include <json.hpp>
 #include <openssl/ssl.h>
 #include <openssl/err.h>
 #include <openssl/bio.h>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstring>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <random>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+#ifdef _WIN32
+#include <winsock2.h>
+#else
+#include <sys/socket.h>
+#include <sys/time.h>
+#endif
 namespace duckdb
 {
 
-    std::string perform_https_request(const std::string &host, const std::string &path, const std::string &token,
-                                      HttpMethod method, const std::string &body, const std::string &content_type)
+    //! Connections idle for longer than this are closed instead of reused
+    static constexpr std::chrono::seconds IDLE_CONNECTION_TIMEOUT(30);
+    //! Maximum number of idle connections kept per host
+    static constexpr size_t MAX_IDLE_CONNECTIONS_PER_HOST = 8;
+    //! Longest wait for a connection to accept or deliver bytes, after which the connection is dropped and the
+    //! request fails with an IOException, retried like a broken connection
+    static constexpr std::chrono::seconds SOCKET_TIMEOUT(60);
+
+    //! Bounds the blocking reads and writes of the socket of a connection, including the TLS handshake
+    static void set_socket_timeouts(BIO *bio)
+    {
+        int fd = -1;
+        if (BIO_get_fd(bio, &fd) <= 0 || fd < 0)
+        {
+            throw duckdb::IOException("Failed to get the socket of the connection");
+        }
+#ifdef _WIN32
+        DWORD timeout = static_cast<DWORD>(std::chrono::milliseconds(SOCKET_TIMEOUT).count());
+        auto option = reinterpret_cast<const char *>(&timeout);
+#else
+        struct timeval timeout;
+        timeout.tv_sec = SOCKET_TIMEOUT.count();
+        timeout.tv_usec = 0;
+        auto option = &timeout;
+#endif
+        if (setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, option, sizeof(timeout)) != 0 ||
+            setsockopt(fd, SOL_SOCKET, SO_SNDTIMEO, option, sizeof(timeout)) != 0)
+        {
+            throw duckdb::IOException("Failed to set the timeouts of the connection");
+        }
+    }
+
+    //! Process-wide pool of kept-alive TLS connections, keyed by host. All connections share one SSL_CTX, and new
+    //! connections to a host resume the TLS session of a previous one to skip the full handshake.
+    class HttpsConnectionPool
+    {
+    public:
+        static HttpsConnectionPool &Get()
+        {
+            static HttpsConnectionPool pool;
+            return pool;
+        }
+
+        //! Returns an idle connection to the host, or nullptr if there is none
+        BIO *AcquireIdle(const std::string &host)
+        {
+            std::lock_guard<std::mutex> guard(lock);
+            auto &connections = idle[host];
+            auto now = std::chrono::steady_clock::now();
+            while (!connections.empty())
+            {
+                auto connection = connections.back();
+                connections.pop_back();
+                if (now - connection.last_used < IDLE_CONNECTION_TIMEOUT)
+                {
+                    return connection.bio;
+                }
+                BIO_free_all(connection.bio);
+            }
+            return nullptr;
+        }
+
+        //! Opens a new connection to the host
+        BIO *Connect(const std::string &host)
+        {
+            BIO *bio = BIO_new_ssl_connect(ctx);
+            if (!bio)
+            {
+                throw duckdb::IOException("Failed to create SSL connection");
+            }
+            SSL *ssl;
+            BIO_get_ssl(bio, &ssl);
+            SSL_set_mode(ssl, SSL_MODE_AUTO_RETRY);
+
+            // Hosts without a port (all but local test servers) are reached over 443
+            bool has_port = host.find(':') != std::string::npos;
+            std::string host_name = has_port ? host.substr(0, host.find(':')) : host;
+            SSL_set_tlsext_host_name(ssl, host_name.c_str());
+            BIO_set_conn_hostname(bio, (has_port ? host : host + ":443").c_str());
+
+            {
+                std::lock_guard<std::mutex> guard(lock);
+                auto session = sessions.find(host);
+                if (session != sessions.end())
+                {
+                    SSL_set_session(ssl, session->second);
+                }
+            }
+
+            // Open the socket first, so that the handshake is bounded by its timeouts
+            if (BIO_do_connect(BIO_next(bio)) <= 0)
+            {
+                BIO_free_all(bio);
+                throw duckdb::IOException("Failed to connect");
+            }
+            try
+            {
+                set_socket_timeouts(bio);
+            }
+            catch (...)
+            {
+                BIO_free_all(bio);
+                throw;
+            }
+            if (BIO_do_handshake(bio) <= 0)
+            {
+                BIO_free_all(bio);
+                throw duckdb::IOException("Failed to connect");
+            }
+            return bio;
+        }
+
+        //! Returns a connection whose response was read completely to the pool
+        void Release(const std::string &host, BIO *bio)
+        {
+            SSL *ssl;
+            BIO_get_ssl(bio, &ssl);
+            SSL_SESSION *session = SSL_get1_session(ssl);
+
+            std::lock_guard<std::mutex> guard(lock);
+            if (session)
+            {
+                auto entry = sessions.find(host);
+                if (entry != sessions.end())
+                {
+                    SSL_SESSION_free(entry->second);
+                    entry->second = session;
+                }
+                else
+                {
+                    sessions[host] = session;
+                }
+            }
+            auto &connections = idle[host];
+            if (connections.size() >= MAX_IDLE_CONNECTIONS_PER_HOST)
+            {
+                BIO_free_all(bio);
+                return;
+            }
+            connections.push_back({bio, std::chrono::steady_clock::now()});
+        }
+
+    private:
+        struct IdleConnection
+        {
+            BIO *bio;
+            std::chrono::steady_clock::time_point last_used;
+        };
+
+        HttpsConnectionPool()
+        {
+            ctx = SSL_CTX_new(TLS_client_method());
+            if (!ctx)
+            {
+                throw duckdb::IOException("Failed to create SSL context");
+            }
+            SSL_CTX_set_session_cache_mode(ctx, SSL_SESS_CACHE_CLIENT);
+        }
+
+        // The pool lives for the whole process, its connections and context are released on exit
+        SSL_CTX *ctx;
+        std::mutex lock;
+        std::unordered_map<std::string, std::vector<IdleConnection>> idle;
+        std::unordered_map<std::string, SSL_SESSION *> sessions;
+    };
+
+    //! Upper bound of the backoff between two attempts of a request
+    static constexpr std::chrono::milliseconds MAX_BACKOFF(64000);
+    //! Upper bound of the delay asked for by a Retry-After header
+    static constexpr std::chrono::seconds MAX_RETRY_AFTER(300);
+
+    RequestSettings GetRequestSettings(ClientContext &context)
+    {
+        RequestSettings settings;
+        Value value;
+        if (context.TryGetCurrentSetting(RequestSettings::REQUESTS_PER_MINUTE_SETTING, value) && !value.IsNull())
+        {
+            settings.requests_per_minute = value.GetValue<double>();
+        }
+        if (context.TryGetCurrentSetting(RequestSettings::MAX_RETRIES_SETTING, value) && !value.IsNull())
+        {
+            settings.max_retries = std::max<int64_t>(value.GetValue<int64_t>(), 0);
+        }
+        return settings;
+    }
+
+    //! Buckets are full again after a minute without requests
+    static constexpr std::chrono::seconds BUCKET_REFILL_WINDOW(60);
+
+    RequestRateLimiter::RequestRateLimiter()
+        : RequestRateLimiter([]() { return std::chrono::steady_clock::now(); },
+                             [](std::chrono::steady_clock::duration wait) { std::this_thread::sleep_for(wait); })
+    {
+    }
+
+    RequestRateLimiter::RequestRateLimiter(clock_function_t clock, sleep_function_t sleep)
+        : clock(std::move(clock)), sleep(std::move(sleep))
+    {
+        last_eviction = this->clock();
+    }
+
+    RequestRateLimiter &RequestRateLimiter::Get()
+    {
+        static RequestRateLimiter limiter;
+        return limiter;
+    }
+
+    void RequestRateLimiter::Acquire(const std::string &key, double requests_per_minute)
     {
-        std::string response;
-        SSL_CTX *ctx = SSL_CTX_new(TLS_client_method());
-        if (!ctx)
+        if (requests_per_minute <= 0)
+        {
+            return;
+        }
+        std::unique_lock<std::mutex> guard(lock);
+        while (true)
         {
-            throw duckdb::IOException("Failed to create SSL context");
+            auto now = clock();
+            auto &bucket = Refill(key, requests_per_minute, now);
+            std::chrono::steady_clock::duration wait;
+            if (now < bucket.paused_until)
+            {
+                wait = bucket.paused_until - now;
+            }
+            else if (bucket.tokens >= 1)
+            {
+                bucket.tokens -= 1;
+                return;
+            }
+            else
+            {
+                wait = std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+                    std::chrono::duration<double>((1 - bucket.tokens) * 60 / requests_per_minute));
+            }
+            guard.unlock();
+            sleep(wait);
+            guard.lock();
         }
+    }
 
-        BIO *bio = BIO_new_ssl_connect(ctx);
-        SSL *ssl;
-        BIO_get_ssl(bio, &ssl);
-        SSL_set_mode(ssl, SSL_MODE_AUTO_RETRY);
+    void RequestRateLimiter::Pause(const std::string &key, double requests_per_minute, std::chrono::milliseconds delay)
+    {
+        std::lock_guard<std::mutex> guard(lock);
+        auto now = clock();
+        auto &bucket = Refill(key, requests_per_minute, now);
+        bucket.paused_until = std::max(bucket.paused_until, now + delay);
+    }
 
-        BIO_set_conn_hostname(bio, (host + ":443").c_str());
+    double RequestRateLimiter::Headroom(const std::string &key, double requests_per_minute)
+    {
+        if (requests_per_minute <= 0)
+        {
+            return 1;
+        }
+        std::lock_guard<std::mutex> guard(lock);
+        auto now = clock();
+        auto &bucket = Refill(key, requests_per_minute, now);
+        if (now < bucket.paused_until)
+        {
+            return 0;
+        }
+        return std::max(bucket.tokens, 0.0) / requests_per_minute;
+    }
+
+    void RequestRateLimiter::Sleep(std::chrono::steady_clock::duration wait)
+    {
+        sleep(wait);
+    }
 
-        if (BIO_do_connect(bio) <= 0)
+    size_t RequestRateLimiter::BucketCount()
+    {
+        std::lock_guard<std::mutex> guard(lock);
+        return buckets.size();
+    }
+
+    RequestRateLimiter::Bucket &RequestRateLimiter::Refill(const std::string &key, double requests_per_minute, time_point_t now)
+    {
+        EvictIdle(now);
+        auto entry = buckets.find(key);
+        if (entry == buckets.end())
         {
-            BIO_free_all(bio);
-            SSL_CTX_free(ctx);
-            throw duckdb::IOException("Failed to connect");
+            return buckets.emplace(key, Bucket {requests_per_minute, now, now}).first->second;
         }
+        auto &bucket = entry->second;
+        std::chrono::duration<double> elapsed = now - bucket.last_refill;
+        bucket.tokens = std::min(requests_per_minute, bucket.tokens + elapsed.count() * requests_per_minute / 60);
+        bucket.last_refill = now;
+        return bucket;
+    }
 
+    void RequestRateLimiter::EvictIdle(time_point_t now)
+    {
+        // Sweeping at most once per window keeps the calls in between constant time
+        if (now - last_eviction < BUCKET_REFILL_WINDOW)
+        {
+            return;
+        }
+        last_eviction = now;
+        for (auto entry = buckets.begin(); entry != buckets.end();)
+        {
+            auto &bucket = entry->second;
+            auto idle_since = std::max(bucket.last_refill, bucket.paused_until);
+            if (now - idle_since >= BUCKET_REFILL_WINDOW)
+            {
+                entry = buckets.erase(entry);
+            }
+            else
+            {
+                ++entry;
+            }
+        }
+    }
+
+    //! Buckets are keyed by a hash of the token, so that the limiter does not keep tokens
+    static std::string get_rate_limit_key(const std::string &token, HttpMethod method)
+    {
+        return (method == HttpMethod::GET ? "read " : "write ") + get_token_key(token);
+    }
+
+    //! Maximum number of requests in flight per host, further requests wait in a queue
+    static constexpr size_t MAX_CONCURRENT_REQUESTS_PER_HOST = MAX_IDLE_CONNECTIONS_PER_HOST;
+    //! Workers idle for longer than this exit, they are started again by the next request
+    static constexpr std::chrono::seconds IDLE_WORKER_TIMEOUT(5);
+
+    //! Process-wide engine running requests in the background. Each host has a queue of requests and up to
+    //! MAX_CONCURRENT_REQUESTS_PER_HOST workers taking requests from it, each on a kept-alive connection of the pool.
+    //! Callers get a future, and can decode or encode other data while their requests are in flight.
+    class HttpRequestEngine
+    {
+    public:
+        static HttpRequestEngine &Get()
+        {
+            // Never destroyed, so that detached workers still waiting for requests at exit find it alive
+            static HttpRequestEngine *engine = new HttpRequestEngine();
+            return *engine;
+        }
+
+        std::future<HttpResponse> Submit(const std::string &host, std::function<HttpResponse()> request)
+        {
+            std::packaged_task<HttpResponse()> task(std::move(request));
+            auto result = task.get_future();
+            bool start_worker = false;
+            {
+                std::lock_guard<std::mutex> guard(lock);
+                auto &queue = hosts[host];
+                queue.pending.push_back(std::move(task));
+                // An idle worker takes the request, otherwise a new one is started unless the host is at its limit
+                if (queue.idle_workers == 0 && queue.workers < MAX_CONCURRENT_REQUESTS_PER_HOST)
+                {
+                    queue.workers++;
+                    start_worker = true;
+                }
+                else
+                {
+                    queue.ready.notify_one();
+                }
+            }
+            if (start_worker)
+            {
+                std::thread(&HttpRequestEngine::Work, this, host).detach();
+            }
+            return result;
+        }
+
+    private:
+        struct HostQueue
+        {
+            std::deque<std::packaged_task<HttpResponse()>> pending;
+            std::condition_variable ready;
+            size_t workers = 0;
+            //! Workers waiting for a request
+            size_t idle_workers = 0;
+        };
+
+        HttpRequestEngine() = default;
+
+        // Runs the requests queued for the host until none arrives for IDLE_WORKER_TIMEOUT
+        void Work(std::string host)
+        {
+            std::unique_lock<std::mutex> guard(lock);
+            // Elements of an unordered_map stay in place when it grows
+            auto &queue = hosts[host];
+            while (true)
+            {
+                if (queue.pending.empty())
+                {
+                    queue.idle_workers++;
+                    bool has_request = queue.ready.wait_for(guard, IDLE_WORKER_TIMEOUT, [&]() { return !queue.pending.empty(); });
+                    queue.idle_workers--;
+                    if (!has_request)
+                    {
+                        queue.workers--;
+                        return;
+                    }
+                }
+                auto task = std::move(queue.pending.front());
+                queue.pending.pop_front();
+                guard.unlock();
+                // Exceptions are stored in the future of the request
+                task();
+                guard.lock();
+            }
+        }
+
+        std::mutex lock;
+        std::unordered_map<std::string, HostQueue> hosts;
+    };
+
+    //! Size of the buffer responses are read into, large enough for a TLS record at a time
+    static constexpr size_t READ_BUFFER_SIZE = 65536;
+
+    // Reads one HTTP/1.1 response from the connection. keep_alive is set to whether the connection can be reused
+    // for another request, received to whether any byte of the response arrived.
+    static HttpResponse read_response(BIO *bio, bool &keep_alive, bool &received)
+    {
+        HttpResponse response;
+        HttpResponseParser parser(response);
+        std::unique_ptr<char[]> buffer(new char[READ_BUFFER_SIZE]);
+        while (true)
+        {
+            int len = BIO_read(bio, buffer.get(), READ_BUFFER_SIZE);
+            if (len <= 0)
+            {
+                // A read that timed out is not the end of the response, even one read until the connection closes
+                if (BIO_should_retry(bio))
+                {
+                    throw duckdb::IOException("Timed out reading the response");
+                }
+                if (!parser.Finish())
+                {
+                    throw duckdb::IOException("Connection closed before the response was received");
+                }
+                break;
+            }
+            received = true;
+            if (parser.Feed(buffer.get(), len))
+            {
+                break;
+            }
+        }
+        keep_alive = parser.KeepAlive();
+        return response;
+    }
+
+    std::string get_response_error(const HttpResponse &response)
+    {
+        // Google APIs report errors as {"error": {"code": ..., "message": ..., "status": ...}}
+        try
+        {
+            auto body = nlohmann::json::parse(response.body);
+            if (body.contains("error") && body["error"].is_object() && body["error"].contains("message"))
+            {
+                return std::to_string(response.status) + " - " + body["error"]["message"].get<std::string>();
+            }
+        }
+        catch (nlohmann::json::exception &)
+        {
+        }
+        return std::to_string(response.status) + " - " + response.body;
+    }
+
+    // Sends a request on a kept-alive connection to the host and reads its response, on the calling thread
+    static HttpResponse execute_https_request(const std::string &host, const std::string &path, const std::string &token,
+                                              HttpMethod method, const std::string &body, const std::string &content_type)
+    {
         std::string method_str;
         switch (method)
         {
@@ -44,14 +507,20 @@ namespace duckdb
             break;
         }
 
-        std::string request = method_str + " " + path + " HTTP/1.0\r\n";
+        std::string request = method_str + " " + path + " HTTP/1.1\r\n";
         request += "Host: " + host + "\r\n";
         request += "Authorization: Bearer " + token + "\r\n";
-        request += "Connection: close\r\n";
+        request += "Connection: keep-alive\r\n";
+        // Google APIs only compress responses for user agents that mention gzip
+        request += "Accept-Encoding: gzip\r\n";
+        request += "User-Agent: duckdb-gsheets (gzip)\r\n";
 
         if (!body.empty())
         {
             request += "Content-Type: " + content_type + "\r\n";
+        }
+        if (!body.empty() || method != HttpMethod::GET)
+        {
             request += "Content-Length: " + std::to_string(body.length()) + "\r\n";
         }
 
@@ -62,36 +531,159 @@ namespace duckdb
             request += body;
         }
 
-        
+        auto &pool = HttpsConnectionPool::Get();
+        BIO *bio = pool.AcquireIdle(host);
+        bool reused = bio != nullptr;
+        while (true)
+        {
+            if (!bio)
+            {
+                bio = pool.Connect(host);
+            }
+            bool received = false;
+            try
+            {
+                if (BIO_write(bio, request.c_str(), request.length()) <= 0)
+                {
+                    throw duckdb::IOException(BIO_should_retry(bio) ? "Timed out writing request" : "Failed to write request");
+                }
+                bool keep_alive;
+                HttpResponse response = read_response(bio, keep_alive, received);
+                if (keep_alive)
+                {
+                    pool.Release(host, bio);
+                }
+                else
+                {
+                    BIO_free_all(bio);
+                }
+                return response;
+            }
+            catch (duckdb::IOException &)
+            {
+                BIO_free_all(bio);
+                bio = nullptr;
+                // The server may have closed an idle connection before reading the request, retry once on a new one
+                if (!reused || received)
+                {
+                    throw;
+                }
+                reused = false;
+            }
+        }
+    }
 
-        if (BIO_write(bio, request.c_str(), request.length()) <= 0)
+    bool is_retryable_status(int status, HttpMethod method)
+    {
+        if (status == 429 || status == 503)
         {
-            BIO_free_all(bio);
-            SSL_CTX_free(ctx);
-            throw duckdb::IOException("Failed to write request");
+            return true;
         }
+        return (status == 500 || status == 502 || status == 504) && method != HttpMethod::POST;
+    }
 
-        char buffer[1024];
-        int len;
-        while ((len = BIO_read(bio, buffer, sizeof(buffer))) > 0)
+    std::chrono::milliseconds get_retry_delay(const HttpResponse *response, int64_t attempt)
+    {
+        if (response)
         {
-            response.append(buffer, len);
+            auto retry_after = response->headers.find("retry-after");
+            // The HTTP date form of Retry-After is not used by Google APIs, it falls back to backoff
+            if (retry_after != response->headers.end() && !retry_after->second.empty() &&
+                retry_after->second.size() < 10 && retry_after->second.find_first_not_of("0123456789") == std::string::npos)
+            {
+                return std::min<std::chrono::milliseconds>(std::chrono::seconds(std::stoll(retry_after->second)), MAX_RETRY_AFTER);
+            }
         }
+        static thread_local std::mt19937 generator(std::random_device {}());
+        std::uniform_int_distribution<int> jitter(0, 999);
+        auto backoff = std::chrono::milliseconds(1000LL << std::min<int64_t>(attempt, 6));
+        return std::min<std::chrono::milliseconds>(backoff + std::chrono::milliseconds(jitter(generator)), MAX_BACKOFF);
+    }
 
-        BIO_free_all(bio);
-        SSL_CTX_free(ctx);
+    // Waits for the rate limit of the user on the calling thread, then queues an attempt of the request on the engine
+    static std::future<HttpResponse> submit_attempt(const std::string &host, const std::string &path, const std::string &token,
+                                                    const RequestSettings &settings, HttpMethod method, const std::string &body,
+                                                    const std::string &content_type)
+    {
+        RequestRateLimiter::Get().Acquire(get_rate_limit_key(token, method), settings.requests_per_minute);
+        return HttpRequestEngine::Get().Submit(host, [=]() {
+            return execute_https_request(host, path, token, method, body, content_type);
+        });
+    }
 
-        // Extract body from response
-        size_t body_start = response.find("\r\n\r\n");
-        if (body_start != std::string::npos)
+    // Takes the response of the first attempt of a request, retrying it on throttling, server errors and connection
+    // failures up to max_retries times. Runs on the thread that takes the response, so the backoff never holds up a
+    // worker of the engine, and other requests to the host keep going out meanwhile.
+    static HttpResponse complete_with_retries(std::future<HttpResponse> attempt_response, send_attempt_t send_attempt,
+                                              RequestSettings settings, HttpMethod method, RequestRateLimiter *limiter,
+                                              std::string key)
+    {
+        for (int64_t attempt = 0;; attempt++)
         {
-            return response.substr(body_start + 4);
+            bool can_retry = attempt < settings.max_retries;
+            std::chrono::milliseconds delay;
+            try
+            {
+                HttpResponse response = attempt_response.get();
+                if (!can_retry || !is_retryable_status(response.status, method))
+                {
+                    return response;
+                }
+                delay = get_retry_delay(&response, attempt);
+                if (response.status == 429)
+                {
+                    limiter->Pause(key, settings.requests_per_minute, delay);
+                }
+            }
+            catch (duckdb::IOException &)
+            {
+                // The connection may have failed after the request was processed
+                if (!can_retry || method == HttpMethod::POST)
+                {
+                    throw;
+                }
+                delay = get_retry_delay(nullptr, attempt);
+            }
+            limiter->Sleep(delay);
+            attempt_response = send_attempt();
         }
+    }
 
-        return response;
+    std::future<HttpResponse> defer_retries(std::future<HttpResponse> first_attempt, send_attempt_t send_attempt,
+                                            const RequestSettings &settings, HttpMethod method, RequestRateLimiter &limiter,
+                                            const std::string &key)
+    {
+        return std::async(std::launch::deferred, complete_with_retries, std::move(first_attempt), std::move(send_attempt),
+                          settings, method, &limiter, key);
+    }
+
+    std::future<HttpResponse> submit_https_request(const std::string &host, const std::string &path, const std::string &token,
+                                                   const RequestSettings &settings, HttpMethod method, const std::string &body,
+                                                   const std::string &content_type)
+    {
+        // The first attempt is in flight once this returns, retries are sent when the response is taken from the future
+        auto first_attempt = submit_attempt(host, path, token, settings, method, body, content_type);
+        send_attempt_t send_attempt = [=]() {
+            return submit_attempt(host, path, token, settings, method, body, content_type);
+        };
+        return defer_retries(std::move(first_attempt), std::move(send_attempt), settings, method, RequestRateLimiter::Get(),
+                             get_rate_limit_key(token, method));
+    }
+
+    HttpResponse perform_https_request(const std::string &host, const std::string &path, const std::string &token,
+                                      const RequestSettings &settings, HttpMethod method, const std::string &body,
+                                      const std::string &content_type)
+    {
+        return submit_https_request(host, path, token, settings, method, body, content_type).get();
     }
 
-    std::string call_sheets_api(const std::string &spreadsheet_id, const std::string &token, const std::string &sheet_name, HttpMethod method, const std::string &body)
+    size_t get_batch_scale(const std::string &token, const RequestSettings &settings, HttpMethod method)
+    {
+        double headroom = RequestRateLimiter::Get().Headroom(get_rate_limit_key(token, method), settings.requests_per_minute);
+        return headroom >= 0.5 ? 1 : headroom >= 0.25 ? 2 : 4;
+    }
+
+    HttpResponse call_sheets_api(const std::string &spreadsheet_id, const std::string &token, const RequestSettings &settings, const std::string &sheet_name, HttpMethod method, const std::string &body)
     {
         std::string host = "sheets.googleapis.com";
         std::string path = "/v4/spreadsheets/" + spreadsheet_id + "/values/" + sheet_name;
@@ -101,21 +693,101 @@ namespace duckdb
             path += "?valueInputOption=USER_ENTERED";
         }
 
-        return perform_https_request(host, path, token, method, body);
+        return perform_https_request(host, path, token, settings, method, body);
     }
 
-    std::string delete_sheet_data(const std::string &spreadsheet_id, const std::string &token, const std::string &sheet_name)
+    std::future<HttpResponse> batch_get_sheet_values_async(const std::string &spreadsheet_id, const std::string &token, const RequestSettings &settings, const std::vector<std::string> &ranges, const std::string &render_options)
+    {
+        std::string host = "sheets.googleapis.com";
+        std::string path = "/v4/spreadsheets/" + spreadsheet_id + "/values:batchGet?majorDimension=ROWS" + render_options;
+
+        for (const auto &range : ranges) {
+            path += "&ranges=" + range;
+        }
+
+        return submit_https_request(host, path, token, settings, HttpMethod::GET);
+    }
+
+    HttpResponse batch_get_sheet_values(const std::string &spreadsheet_id, const std::string &token, const RequestSettings &settings, const std::vector<std::string> &ranges, const std::string &render_options)
+    {
+        return batch_get_sheet_values_async(spreadsheet_id, token, settings, ranges, render_options).get();
+    }
+
+    std::future<HttpResponse> get_sheet_cells_async(const std::string &spreadsheet_id, const std::string &token, const RequestSettings &settings, const std::string &range)
+    {
+        std::string host = "sheets.googleapis.com";
+        std::string path = "/v4/spreadsheets/" + spreadsheet_id + "?ranges=" + range +
+                           "&fields=" + url_encode("sheets.data.rowData.values(effectiveValue,effectiveFormat.numberFormat.type)");
+
+        return submit_https_request(host, path, token, settings, HttpMethod::GET);
+    }
+
+    HttpResponse get_sheet_cells(const std::string &spreadsheet_id, const std::string &token, const RequestSettings &settings, const std::string &range)
+    {
+        return get_sheet_cells_async(spreadsheet_id, token, settings, range).get();
+    }
+
+    std::future<HttpResponse> update_sheet_values_async(const std::string &spreadsheet_id, const std::string &token, const RequestSettings &settings, const std::string &range, const std::string &body, const std::string &value_input_option)
+    {
+        std::string host = "sheets.googleapis.com";
+        std::string path = "/v4/spreadsheets/" + spreadsheet_id + "/values/" + range + "?valueInputOption=" + value_input_option;
+
+        return submit_https_request(host, path, token, settings, HttpMethod::PUT, body);
+    }
+
+    HttpResponse update_sheet_values(const std::string &spreadsheet_id, const std::string &token, const RequestSettings &settings, const std::string &range, const std::string &body, const std::string &value_input_option)
+    {
+        return update_sheet_values_async(spreadsheet_id, token, settings, range, body, value_input_option).get();
+    }
+
+    HttpResponse append_sheet_values(const std::string &spreadsheet_id, const std::string &token, const RequestSettings &settings, const std::string &range, const std::string &body, const std::string &value_input_option)
+    {
+        std::string host = "sheets.googleapis.com";
+        std::string path = "/v4/spreadsheets/" + spreadsheet_id + "/values/" + range + ":append?valueInputOption=" + value_input_option;
+
+        return perform_https_request(host, path, token, settings, HttpMethod::POST, body);
+    }
+
+    std::future<HttpResponse> batch_update_sheet_values_async(const std::string &spreadsheet_id, const std::string &token, const RequestSettings &settings, const std::string &body)
+    {
+        std::string host = "sheets.googleapis.com";
+        std::string path = "/v4/spreadsheets/" + spreadsheet_id + "/values:batchUpdate";
+
+        return submit_https_request(host, path, token, settings, HttpMethod::POST, body);
+    }
+
+    std::future<HttpResponse> batch_update_spreadsheet_async(const std::string &spreadsheet_id, const std::string &token, const RequestSettings &settings, const std::string &body)
+    {
+        std::string host = "sheets.googleapis.com";
+        std::string path = "/v4/spreadsheets/" + spreadsheet_id + ":batchUpdate";
+
+        return submit_https_request(host, path, token, settings, HttpMethod::POST, body);
+    }
+
+    HttpResponse batch_update_spreadsheet(const std::string &spreadsheet_id, const std::string &token, const RequestSettings &settings, const std::string &body)
+    {
+        return batch_update_spreadsheet_async(spreadsheet_id, token, settings, body).get();
+    }
+
+    HttpResponse delete_sheet_data(const std::string &spreadsheet_id, const std::string &token, const RequestSettings &settings, const std::string &sheet_name)
     {
         std::string host = "sheets.googleapis.com";
         std::string path = "/v4/spreadsheets/" + spreadsheet_id + "/values/" + sheet_name + ":clear";
 
-        return perform_https_request(host, path, token, HttpMethod::POST, "{}");
+        return perform_https_request(host, path, token, settings, HttpMethod::POST, "{}");
+    }
+
+    HttpResponse get_drive_file(const std::string &file_id, const std::string &token, const RequestSettings &settings, const std::string &fields)
+    {
+        std::string host = "www.googleapis.com";
+        std::string path = "/drive/v3/files/" + file_id + "?supportsAllDrives=true&fields=" + url_encode(fields);
+        return perform_https_request(host, path, token, settings, HttpMethod::GET, "");
     }
 
-    std::string get_spreadsheet_metadata(const std::string &spreadsheet_id, const std::string &token)
+    HttpResponse get_spreadsheet_metadata(const std::string &spreadsheet_id, const std::string &token, const RequestSettings &settings)
     {
         std::string host = "sheets.googleapis.com";
         std::string path = "/v4/spreadsheets/" + spreadsheet_id + "?&fields=sheets.properties";
-        return perform_https_request(host, path, token, HttpMethod::GET, "");
+        return perform_https_request(host, path, token, settings, HttpMethod::GET, "");
     }
 }
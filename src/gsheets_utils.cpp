@@ -39,26 +39,44 @@ std::string extract_sheet_id(const std::string& input) {
     return "0";
 }
 
-std::string get_sheet_name_from_id(const std::string& spreadsheet_id, const std::string& sheet_id, const std::string& token) {
-    std::string metadata_response = get_spreadsheet_metadata(spreadsheet_id, token);
-    json metadata = parseJson(metadata_response);
-    for (const auto& sheet : metadata["sheets"]) {
-        if (sheet["properties"]["sheetId"].get<int>() == std::stoi(sheet_id)) {
-            return sheet["properties"]["title"].get<std::string>();
-        }
+static SheetProperties parse_sheet_properties(const json& properties) {
+    SheetProperties result;
+    result.sheet_id = std::to_string(properties["sheetId"].get<int64_t>());
+    result.title = properties["title"].get<std::string>();
+    result.row_count = 0;
+    result.column_count = 0;
+    if (properties.contains("gridProperties")) {
+        const auto& grid = properties["gridProperties"];
+        result.row_count = grid.value("rowCount", 0);
+        result.column_count = grid.value("columnCount", 0);
     }
-    throw duckdb::InvalidInputException("Sheet with ID %s not found", sheet_id);
+    return result;
 }
 
-std::string get_sheet_id_from_name(const std::string& spreadsheet_id, const std::string& sheet_name, const std::string& token) {
-    std::string metadata_response = get_spreadsheet_metadata(spreadsheet_id, token);
-    json metadata = parseJson(metadata_response);
+std::vector<SheetProperties> get_spreadsheet_sheets(const std::string& spreadsheet_id, const std::string& token, const RequestSettings& settings) {
+    HttpResponse response = get_spreadsheet_metadata(spreadsheet_id, token, settings);
+    if (!response.IsSuccess()) {
+        throw duckdb::IOException("Error fetching spreadsheet metadata: " + get_response_error(response));
+    }
+    json metadata = parseJson(response.body);
+    std::vector<SheetProperties> sheets;
     for (const auto& sheet : metadata["sheets"]) {
-        if (sheet["properties"]["title"].get<std::string>() == sheet_name) {
-            return sheet["properties"]["sheetId"].get<std::string>();
-        }
+        sheets.push_back(parse_sheet_properties(sheet["properties"]));
     }
-    throw duckdb::InvalidInputException("Sheet with name %s not found", sheet_name);
+    return sheets;
+}
+
+std::string get_spreadsheet_version(const std::string& spreadsheet_id, const std::string& token, const RequestSettings& settings) {
+    HttpResponse response = get_drive_file(spreadsheet_id, token, settings, "version");
+    if (!response.IsSuccess()) {
+        return "";
+    }
+    json file = json::parse(response.body, nullptr, false);
+    if (!file.is_object() || !file.contains("version")) {
+        return "";
+    }
+    // Versions are int64 values, sent as strings
+    return file["version"].is_string() ? file["version"].get<std::string>() : file["version"].dump();
 }
 
 json parseJson(const std::string& json_str) {
@@ -87,24 +105,6 @@ json parseJson(const std::string& json_str) {
     }
 }
 
-SheetData getSheetData(const json& j) {
-    SheetData result;
-    if (j.contains("range") && j.contains("majorDimension") && j.contains("values")) {
-        result.range = j["range"].get<std::string>();
-        result.majorDimension = j["majorDimension"].get<std::string>();
-        result.values = j["values"].get<std::vector<std::vector<std::string>>>();
-    } else if (j.contains("error")) {
-        string message = j["error"]["message"].get<std::string>();
-            int code = j["error"]["code"].get<int>();
-            throw std::runtime_error("Google Sheets API error: " + std::to_string(code) + " - " + message);
-        } else {
-        std::cerr << "JSON does not contain expected fields" << std::endl;
-        std::cerr << "Raw JSON string: " << j.dump() << std::endl;
-        throw;
-    }
-    return result;
-}
-
 std::string generate_random_string(size_t length) {
     static const char charset[] =
         "0123456789"
@@ -123,6 +123,83 @@ std::string generate_random_string(size_t length) {
     return result;
 }
 
+// Parses one side of an A1 range, e.g. B12, B or 12
+static void parse_a1_cell(const std::string& cell, const std::string& range, size_t& column, size_t& row) {
+    size_t pos = 0;
+    column = 0;
+    while (pos < cell.size() && isalpha(static_cast<unsigned char>(cell[pos]))) {
+        column = column * 26 + (toupper(static_cast<unsigned char>(cell[pos])) - 'A' + 1);
+        pos++;
+    }
+    row = 0;
+    while (pos < cell.size() && isdigit(static_cast<unsigned char>(cell[pos]))) {
+        row = row * 10 + (cell[pos] - '0');
+        pos++;
+    }
+    if (cell.empty() || pos != cell.size() || (column == 0 && row == 0)) {
+        throw duckdb::InvalidInputException("Invalid A1 range: %s", range);
+    }
+}
+
+SheetRange parse_sheet_range(const std::string& range) {
+    SheetRange result;
+    std::string cells = range;
+    size_t bang = range.rfind('!');
+    if (bang != std::string::npos) {
+        result.sheet_name = range.substr(0, bang);
+        if (result.sheet_name.size() >= 2 && result.sheet_name.front() == '\'' && result.sheet_name.back() == '\'') {
+            // Undo quote_sheet_name: strip the quotes and collapse the doubled quotes within the name
+            std::string quoted = result.sheet_name.substr(1, result.sheet_name.size() - 2);
+            result.sheet_name.clear();
+            for (size_t i = 0; i < quoted.size(); i++) {
+                result.sheet_name += quoted[i];
+                if (quoted[i] == '\'' && i + 1 < quoted.size() && quoted[i + 1] == '\'') {
+                    i++;
+                }
+            }
+        }
+        cells = range.substr(bang + 1);
+    }
+
+    size_t colon = cells.find(':');
+    parse_a1_cell(cells.substr(0, colon), range, result.first_column, result.first_row);
+    if (colon == std::string::npos) {
+        // A single cell
+        result.last_column = result.first_column;
+        result.last_row = result.first_row;
+    } else {
+        parse_a1_cell(cells.substr(colon + 1), range, result.last_column, result.last_row);
+    }
+    if ((result.last_row != 0 && result.last_row < result.first_row) ||
+        (result.last_column != 0 && result.last_column < result.first_column)) {
+        throw duckdb::InvalidInputException("Invalid A1 range: %s", range);
+    }
+    return result;
+}
+
+std::string column_index_to_letter(size_t column_index) {
+    std::string letters;
+    size_t remaining = column_index + 1;
+    while (remaining > 0) {
+        size_t digit = (remaining - 1) % 26;
+        letters.insert(letters.begin(), static_cast<char>('A' + digit));
+        remaining = (remaining - 1) / 26;
+    }
+    return letters;
+}
+
+std::string quote_sheet_name(const std::string& sheet_name) {
+    std::string quoted = "'";
+    for (char c : sheet_name) {
+        // Quotes within the name are doubled
+        if (c == '\'') {
+            quoted += '\'';
+        }
+        quoted += c;
+    }
+    return quoted + "'";
+}
+
 std::string url_encode(const std::string& str) {
     std::string encoded;
     for (char c : str) {
@@ -137,4 +214,16 @@ std::string url_encode(const std::string& str) {
     return encoded;
 }
 
+std::string get_token_key(const std::string& token) {
+    // 64-bit FNV-1a, stable across processes so that it can key entries on disk too
+    uint64_t hash = 14695981039346656037ULL;
+    for (char c : token) {
+        hash ^= static_cast<unsigned char>(c);
+        hash *= 1099511628211ULL;
+    }
+    std::stringstream ss;
+    ss << std::hex << hash;
+    return ss.str();
+}
+
 } // namespace duckdb
\ No newline at end of file
@@ -3,25 +3,164 @@
 #pragma once
 
 #include "duckdb/function/copy_function.hpp"
+#include "duckdb/common/mutex.hpp"
+#include "duckdb/common/unordered_set.hpp"
+#include "gsheets_encoder.hpp"
+#include "gsheets_requests.hpp"
+
+#include <condition_variable>
+#include <deque>
 
 namespace duckdb
 {
+    // Rows waiting to be written, serialized as the comma separated JSON arrays of a values request
+    struct GSheetRowBuffer
+    {
+        string values;
+        idx_t row_count = 0;
+
+        void Clear()
+        {
+            values.clear();
+            row_count = 0;
+        }
+    };
+
+    // Changed rows of a merge, each written over the sheet row holding its key
+    struct GSheetRowUpdates
+    {
+        // The sheet row (1-based) and the JSON array of each changed row
+        vector<std::pair<idx_t, string>> rows;
+        idx_t bytes = 0;
+
+        void Add(idx_t sheet_row, string row)
+        {
+            bytes += row.size();
+            rows.emplace_back(sheet_row, std::move(row));
+        }
+
+        void Clear()
+        {
+            rows.clear();
+            bytes = 0;
+        }
+    };
+
+    // A row of the sheet a merge writes into
+    struct GSheetExistingRow
+    {
+        // The sheet row (1-based)
+        idx_t row;
+        // The cells of the row as they are compared, one per column written, read unformatted and formatted
+        vector<string> cells;
+        vector<string> formatted_cells;
+    };
+
+    // How rows are sent to the sheet (WRITE_METHOD)
+    enum class GSheetWriteMethod : uint8_t
+    {
+        // As JSON values with values:update requests, parsed according to the value input option
+        VALUES,
+        // As typed CellData with updateCells requests of spreadsheets:batchUpdate, stored as they are
+        CELLS
+    };
+
     struct GSheetCopyGlobalState : public GlobalFunctionData
     {
-        explicit GSheetCopyGlobalState(ClientContext &context, const string &spreadsheet_id, const string &token, const string &sheet_name)
-            : spreadsheet_id(spreadsheet_id), token(token), sheet_name(sheet_name)
+        // Number of writes in flight at once, further writes wait for the oldest one
+        static constexpr idx_t MAX_PENDING_WRITES = 4;
+        // Rows the grid grows by at most ahead of the rows written
+        static constexpr idx_t MAX_GROW_AHEAD_ROWS = 100000;
+        // Rows of the grid of a sheet added by a copy, the size of a new sheet in Google Sheets
+        static constexpr idx_t NEW_SHEET_ROWS = 1000;
+
+        explicit GSheetCopyGlobalState(ClientContext &context, const string &spreadsheet_id, const string &token, const string &sheet_name, const string &encoded_sheet_name)
+            : spreadsheet_id(spreadsheet_id), token(token), request_settings(GetRequestSettings(context)), sheet_name(sheet_name), encoded_sheet_name(encoded_sheet_name)
         {
         }
 
     public:
         string spreadsheet_id;
         string token;
+        // The rate limit and retries of the requests of the copy
+        RequestSettings request_settings;
+        // Resolved once when the copy starts, rather than for every chunk
         string sheet_name;
+        string encoded_sheet_name;
+        string sheet_id;
+        // Letter of the last column written
+        string last_column;
+        GSheetWriteMethod write_method = GSheetWriteMethod::VALUES;
+        // RAW or USER_ENTERED, for writes of values
+        string value_input_option;
+
+        mutex lock;
+        // The next sheet row (1-based) handed out to a batch of rows
+        idx_t next_row = 1;
+        // Size of the sheet grid, rows are only written within it
+        idx_t grid_rows = 0;
+        idx_t grid_columns = 0;
+        // Number of rows in the sheet grid when the copy started, finalize trims the grid down to it
+        idx_t initial_grid_rows = 0;
+        // Whether the next batch is appended below the rows already in the sheet, which tells the row it ends at
+        bool append_at_end = false;
+        // Whether a thread is appending the first batch, or growing the grid, outside of the lock. Other threads
+        // waiting for either are woken by rows_changed.
+        bool appending = false;
+        bool growing_grid = false;
+        std::condition_variable rows_changed;
+        // Rows left over by local states once they are done, written by finalize
+        GSheetRowBuffer remainder;
+        // Writes submitted but not yet checked, oldest first
+        std::deque<std::future<HttpResponse>> pending_writes;
+        // The rows of the sheet when a merge started, by key. Only read once the copy is initialized.
+        unordered_map<string, GSheetExistingRow> existing_rows;
+        // The keys written by a merge so far, guarded by lock
+        unordered_set<string> merged_keys;
+    };
+
+    struct GSheetCopyLocalState : public LocalFunctionData
+    {
+        GSheetCopyLocalState(const vector<LogicalType> &types, SheetRowFormat format, bool merge)
+            : encoder(types, format, merge)
+        {
+        }
+
+        SheetRowEncoder encoder;
+        GSheetRowBuffer buffer;
+        GSheetRowUpdates updates;
+        // The comparable cells and the key of every row of the chunk of a merge
+        vector<vector<string>> merge_cells;
+        vector<string> merge_keys;
     };
 
     struct GSheetWriteOptions
     {
+        static constexpr idx_t DEFAULT_BATCH_SIZE = 50000;
+        static constexpr idx_t DEFAULT_BATCH_BYTES = 8 * 1024 * 1024;
+
         vector<string> name_list;
+        // The name of the sheet written (SHEET), added to the spreadsheet if it does not have it. Otherwise the sheet
+        // is the one of the gid in the URL, or the first sheet.
+        string sheet;
+        // Rows are written once this many are buffered (BATCH_SIZE), or once they take up this many bytes of
+        // JSON (BATCH_BYTES)
+        idx_t batch_size = DEFAULT_BATCH_SIZE;
+        idx_t batch_bytes = DEFAULT_BATCH_BYTES;
+        // Whether batches grow beyond batch_size as the write budget runs out, unless BATCH_SIZE is given
+        bool adaptive_batch_size = true;
+        // MODE 'merge': rows are matched to the rows of the sheet by the UPSERT_KEY columns, only changed rows are
+        // written over them and rows with new keys are appended. Otherwise the sheet is cleared and rewritten.
+        bool merge = false;
+        vector<idx_t> key_columns;
+        // APPEND true or OVERWRITE false: the sheet is not cleared, and rows are written below the rows already in
+        // it. The header is only written to an empty sheet, otherwise it must match the columns written.
+        bool append = false;
+        GSheetWriteMethod write_method = GSheetWriteMethod::VALUES;
+        // How the values written are interpreted (VALUE_INPUT_OPTION). Defaults to RAW when every column is a number
+        // or a boolean, which the sheet does not need to parse, and to USER_ENTERED otherwise so that e.g. dates
+        // written as text become dates.
+        string value_input_option;
     };
 
     struct GSheetWriteBindData : public TableFunctionData
@@ -50,6 +189,12 @@ namespace duckdb
         static unique_ptr<LocalFunctionData> GSheetWriteInitializeLocal(ExecutionContext &context, FunctionData &bind_data_p);
 
         static void GSheetWriteSink(ExecutionContext &context, FunctionData &bind_data_p, GlobalFunctionData &gstate, LocalFunctionData &lstate, DataChunk &input);
+
+        static void GSheetWriteCombine(ExecutionContext &context, FunctionData &bind_data_p, GlobalFunctionData &gstate, LocalFunctionData &lstate);
+
+        static void GSheetWriteFinalize(ClientContext &context, FunctionData &bind_data_p, GlobalFunctionData &gstate);
+
+        static CopyFunctionExecutionMode GSheetWriteExecutionMode(bool preserve_insertion_order, bool supports_batch_index);
     };
 
 } // namespace duckdb
\ No newline at end of file
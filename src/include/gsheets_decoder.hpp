@@ -0,0 +1,93 @@
+#pragma once
+
+#include "duckdb.hpp"
+#include "duckdb/common/types/column/column_data_collection.hpp"
+#include "duckdb/main/client_context.hpp"
+
+namespace duckdb {
+
+//! Maps the cells of the ranges of a values:batchGet request to the output columns
+struct SheetColumnMapping {
+    //! The first sheet column of each requested range
+    vector<idx_t> range_columns;
+    //! The number of sheet columns in each requested range
+    vector<idx_t> range_widths;
+    //! For each requested range, the part (e.g. the sheet) it belongs to, empty if every range belongs to part 0.
+    //! The ranges of a part are requested one after the other.
+    vector<idx_t> range_parts;
+    //! For each sheet column, the output column it is decoded into, or DConstants::INVALID_INDEX
+    vector<idx_t> output_columns;
+    //! VARCHAR output columns holding a value per part, e.g. the sheet name, and the values of each part
+    vector<idx_t> constant_columns;
+    vector<vector<string>> part_constants;
+    //! The sheet row (1-based) and column (0-based) of the first cell of each range, and the name of the sheet of
+    //! each part, to name the cells that do not convert to their column type
+    vector<idx_t> range_first_rows;
+    vector<idx_t> range_first_columns;
+    vector<string> part_sheets;
+    //! For each part, the NULL rows decoded above its rows if it holds any, e.g. the empty rows a previous window of
+    //! the sheet ended in, and the NULL rows decoded below its rows. Missing parts have none.
+    vector<idx_t> part_leading_rows;
+    vector<idx_t> part_trailing_rows;
+};
+
+/**
+ * Decodes the rows of a values or values:batchGet response straight into the collection, without building a JSON DOM.
+ * Cells of VARCHAR, BOOLEAN, BIGINT, DOUBLE, DATE and TIMESTAMP columns are parsed straight into vectors of that
+ * type, cells of other columns are cast from strings. Empty cells of non-string columns are NULL.
+ * Numbers and booleans of an unformatted response are stored without a string round trip, numbers in DATE and
+ * TIMESTAMP columns are read as serial numbers.
+ * Rows are aligned across the ranges of a part by their sheet row, which is taken from the range of the response, so
+ * empty rows within a range are NULL rows. The rows of the parts are stacked in order.
+ * @param context The client context
+ * @param response The raw response body
+ * @param mapping Where the cells of each range go in the collection
+ * @param collection The collection to append the decoded rows to
+ * @param part_rows If set, receives for each part the number of rows from the first row of its ranges to the last row
+ * holding a value, without the leading and trailing rows of the mapping. Parts without rows may be missing at the end.
+ * @return The number of rows decoded
+ * @throws IOException if the response is an API error or is not valid JSON
+ * @throws ConversionException naming the cell if a cell does not convert to the type of its column, e.g. a column
+ * sniffed as BIGINT from the sampled rows holding text further down
+ */
+idx_t DecodeSheetValues(ClientContext &context, const string &response, const SheetColumnMapping &mapping,
+                        ColumnDataCollection &collection, vector<idx_t> *part_rows = nullptr);
+
+/**
+ * Reads how many rows of each part of a values:batchGet response hold values, without decoding any cell
+ * @param response The raw response body
+ * @param mapping The parts of the requested ranges, and the sheet row each range was requested from
+ * @return For each part, the number of rows from the first row of its ranges to the last row holding a value
+ * @throws IOException if the response is an API error or is not valid JSON
+ */
+vector<idx_t> DecodeSheetExtents(const string &response, const SheetColumnMapping &mapping);
+
+//! Days from the epoch of serial numbers, 1899-12-30, to the Unix epoch
+constexpr int64_t SERIAL_EPOCH_DAYS = 25569;
+
+//! Converts a serial number, days since 1899-12-30, to a date, returns false if it is out of range
+bool SheetSerialToDate(double serial, date_t &result);
+
+//! Converts a serial number, days since 1899-12-30 with the time as the fraction of a day, to a timestamp, returns
+//! false if it is out of range
+bool SheetSerialToTimestamp(double serial, timestamp_t &result);
+
+/**
+ * Decodes the rows of every range of a values:batchGet response as strings
+ * @param response The raw response body of a values:batchGet
+ * @param range_count The number of requested ranges
+ * @return For each range, its rows, each as wide as the response row
+ * @throws IOException if the response is an API error or is not valid JSON
+ */
+vector<vector<vector<string>>> DecodeSheetRanges(const string &response, idx_t range_count);
+
+/**
+ * Decodes at most max_rows rows of a values response as strings, stopping the parse once they are read
+ * @param response The raw response body of a values GET
+ * @param max_rows The maximum number of rows to decode
+ * @return The decoded rows, each as wide as the response row
+ * @throws IOException if the response is an API error or is not valid JSON
+ */
+vector<vector<string>> DecodeSheetRows(const string &response, idx_t max_rows);
+
+} // namespace duckdb
@@ -0,0 +1,83 @@
+#pragma once
+
+#include "duckdb.hpp"
+#include "duckdb/common/types/column/column_data_collection.hpp"
+#include "duckdb/main/client_context.hpp"
+#include "gsheets_requests.hpp"
+
+namespace duckdb {
+
+//! A read_gsheet result cached on disk: the schema, the decoded rows, and the spreadsheet version they were read at
+struct CachedSheet {
+    //! The Drive version of the spreadsheet when it was read, empty if it could not be fetched
+    string version;
+    //! When the sheet was read, in seconds since the Unix epoch
+    int64_t read_at = 0;
+    vector<string> names;
+    vector<LogicalType> types;
+    shared_ptr<ColumnDataCollection> rows;
+};
+
+//! The Drive version of a spreadsheet, fetched on first use so that a read is revalidated with one request at most
+class SpreadsheetVersion {
+public:
+    SpreadsheetVersion(string spreadsheet_id, string token, RequestSettings settings)
+        : spreadsheet_id(std::move(spreadsheet_id)), token(std::move(token)), settings(settings) {
+    }
+
+    //! The version, or an empty string if it could not be fetched
+    const string &Get();
+
+private:
+    string spreadsheet_id;
+    string token;
+    RequestSettings settings;
+    bool fetched = false;
+    string version;
+};
+
+//! Seconds cached reads are used for before they are revalidated against the spreadsheet version
+int64_t GetSheetCacheTTL(ClientContext &context);
+
+//! Whether a cached read can be used: it was read less than ttl seconds ago, or at the current spreadsheet version
+bool IsCachedSheetFresh(const CachedSheet &sheet, int64_t ttl, SpreadsheetVersion &version);
+
+//! Opt-in cache of read_gsheet results in the gsheets_cache_directory directory. Each read (spreadsheet, sheet, rows,
+//! columns and read options) is a file holding its key, schema and rows, serialized a chunk at a time in the DuckDB binary
+//! format, so a hit is neither downloaded nor parsed. Entries are used for gsheets_cache_ttl seconds, then only if
+//! the version of the spreadsheet is unchanged.
+class SheetDiskCache {
+public:
+    static constexpr const char *DIRECTORY_SETTING = "gsheets_cache_directory";
+    static constexpr const char *TTL_SETTING = "gsheets_cache_ttl";
+    static constexpr int64_t DEFAULT_TTL_SECONDS = 60;
+
+    //! The cache configured for the context, disabled if no directory is set
+    explicit SheetDiskCache(ClientContext &context);
+
+    bool Enabled() const {
+        return !directory.empty();
+    }
+
+    //! The cache file of a read of the spreadsheet, the key identifying the read
+    string GetPath(const string &spreadsheet_id, const string &key) const;
+
+    //! Loads a cached read of the key if it is fresh, returns nullptr on a miss
+    shared_ptr<CachedSheet> Load(const string &path, const string &key, SpreadsheetVersion &version) const;
+
+    //! Writes a read to the cache along with its key. Failures are ignored, the read is downloaded again next time.
+    void Store(const string &path, const string &key, const CachedSheet &sheet) const;
+
+    //! Drops every cached read of the spreadsheet
+    void Invalidate(const string &spreadsheet_id) const;
+
+    //! Drops every cached read
+    void Clear() const;
+
+private:
+    ClientContext &context;
+    string directory;
+    int64_t ttl;
+};
+
+} // namespace duckdb
@@ -0,0 +1,67 @@
+#pragma once
+
+#include "duckdb.hpp"
+#include "duckdb/common/types/data_chunk.hpp"
+
+namespace duckdb {
+
+//! How rows are serialized
+enum class SheetRowFormat : uint8_t {
+    //! The rows of a values request, e.g. [1,"a",true]
+    VALUES,
+    //! The RowData of an updateCells request, e.g. {"values":[{"userEnteredValue":{"numberValue":1}}]}. Dates,
+    //! timestamps and times are written as serial numbers with a matching number format, so they keep their type.
+    CELLS
+};
+
+//! Serializes chunks into the JSON rows of a values request, e.g. [1,"a",true]. Cells are encoded one column at a
+//! time by a writer specialized for the column type, into buffers that are reused across chunks:
+//! - integers, floating point numbers and decimals are written as JSON numbers, and booleans as JSON booleans
+//! - strings are escaped, other types are written as the string of their VARCHAR cast
+//! - NULLs are written as empty strings
+class SheetRowEncoder {
+public:
+    //! With comparable set, the cells are also encoded as they compare with the cells of a sheet, see GetComparableRow
+    explicit SheetRowEncoder(const vector<LogicalType> &types, SheetRowFormat format = SheetRowFormat::VALUES,
+                             bool comparable = false);
+
+    //! Encodes every cell of the chunk, the rows can then be appended with AppendRow
+    void SetChunk(DataChunk &chunk);
+
+    //! Appends a row of the chunk, as a JSON array or as RowData
+    void AppendRow(idx_t row, string &out) const;
+
+    //! The text each cell of a row of the chunk is compared by with the cells of a sheet read unformatted: strings as
+    //! they are, numbers as by AppendComparableNumber, booleans as TRUE or FALSE, dates, timestamps and times as the
+    //! serial numbers of the sheet, and NULLs as empty strings. Needs an encoder built with comparable set.
+    void GetComparableRow(idx_t row, vector<string> &cells) const;
+
+    //! Appends a number as it is compared, with 15 significant digits
+    static void AppendComparableNumber(double value, string &out);
+
+    //! Appends a header row naming the columns
+    static void AppendHeader(const vector<string> &names, SheetRowFormat format, string &out);
+
+private:
+    struct EncodedColumn {
+        //! The encoded cells of the column, back to back
+        string data;
+        //! The start of every cell in data, and the end of the last one
+        vector<idx_t> offsets;
+    };
+
+    //! Dates, timestamps and times are encoded as serial numbers when they have a number format
+    void EncodeColumn(Vector &source, idx_t count, EncodedColumn &column, const char *number_format);
+
+    static void EncodeComparableColumn(Vector &source, idx_t count, EncodedColumn &column);
+
+    vector<LogicalType> types;
+    SheetRowFormat format;
+    //! The number format type of every column written as serial numbers, nullptr for the other columns
+    vector<const char *> number_formats;
+    vector<EncodedColumn> columns;
+    //! The comparable text of every cell, empty unless the encoder is comparable
+    vector<EncodedColumn> comparable_columns;
+};
+
+} // namespace duckdb
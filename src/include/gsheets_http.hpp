@@ -0,0 +1,72 @@
+#pragma once
+
+#include "gsheets_requests.hpp"
+
+#include <zlib.h>
+
+#include <cstddef>
+#include <memory>
+#include <string>
+
+namespace duckdb {
+
+//! Streaming gzip decompressor, the body is inflated piece by piece as it is received
+class GzipInflater {
+public:
+    GzipInflater();
+    ~GzipInflater();
+
+    //! Inflates the compressed bytes and appends the result to out
+    void Inflate(const char* data, size_t len, std::string& out);
+
+    //! Whether the end of the gzip stream was reached
+    bool Finished() const {
+        return finished;
+    }
+
+private:
+    z_stream stream;
+    char buffer[65536];
+    bool finished = false;
+};
+
+//! Incremental HTTP/1.1 response parser. Bytes are fed as they are read from the connection, and the body is decoded
+//! from Content-Length or chunked framing straight into the response, without buffering it twice. gzip encoded bodies
+//! are inflated as they arrive.
+class HttpResponseParser {
+public:
+    explicit HttpResponseParser(HttpResponse& response) : response(response) {
+    }
+
+    //! Consumes received bytes, returns true once the whole response has been read
+    bool Feed(const char* data, size_t len);
+
+    //! Called once the connection is closed, returns true if that completes the response
+    bool Finish();
+
+    //! Whether the connection can be reused for another request
+    bool KeepAlive() const {
+        return keep_alive;
+    }
+
+private:
+    enum class State { STATUS_LINE, HEADERS, BODY, BODY_UNTIL_CLOSE, CHUNK_SIZE, CHUNK_DATA, CHUNK_END, TRAILERS, DONE };
+
+    void ParseLine();
+    void ParseStatusLine();
+    void ParseHeader();
+    void BeginBody();
+    void AppendBody(const char* data, size_t len);
+    void Complete();
+
+    HttpResponse& response;
+    std::unique_ptr<GzipInflater> inflater;
+    State state = State::STATUS_LINE;
+    //! The line being read, in the line based states
+    std::string line;
+    //! Bytes left in the body or the current chunk
+    size_t remaining = 0;
+    bool keep_alive = true;
+};
+
+} // namespace duckdb
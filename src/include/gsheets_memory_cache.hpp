@@ -0,0 +1,123 @@
+#pragma once
+
+#include "duckdb.hpp"
+#include "duckdb/common/list.hpp"
+#include "duckdb/common/mutex.hpp"
+#include "duckdb/function/pragma_function.hpp"
+#include "duckdb/function/table_function.hpp"
+#include "duckdb/main/client_context.hpp"
+#include "duckdb/storage/object_cache.hpp"
+#include "duckdb/common/types/column/column_data_collection.hpp"
+#include "gsheets_disk_cache.hpp"
+
+namespace duckdb {
+
+//! The decoded rows of a window of a read, and for each of its slices the rows from its first row to its last row
+//! holding a value
+struct CachedWindow {
+    shared_ptr<ColumnDataCollection> rows;
+    vector<idx_t> slice_rows;
+};
+
+//! Per-database LRU cache of decoded read_gsheet results, keyed by the spreadsheet and the read (token, sheet, rows,
+//! columns and read options). A read caches its schema at bind, and the rows of each window as the scan decodes them,
+//! per set of projected columns, so reads keep streaming in parallel and only download the columns they project.
+//! Later reads are served the cached windows, e.g. the other side of a self join or the next query. The least
+//! recently used reads are evicted once gsheets_cache_memory_limit is exceeded, and reads expire once they are older
+//! than gsheets_cache_ttl.
+class SheetMemoryCache : public ObjectCacheEntry {
+public:
+    static constexpr const char *MEMORY_LIMIT_SETTING = "gsheets_cache_memory_limit";
+    static constexpr const char *DEFAULT_MEMORY_LIMIT = "64MB";
+
+    static string ObjectType() {
+        return "gsheets_sheet_cache";
+    }
+
+    string GetObjectType() override {
+        return ObjectType();
+    }
+
+    //! The cache of the database the context belongs to
+    static SheetMemoryCache &Get(ClientContext &context);
+
+    //! The memory limit set for the context in bytes, a limit of 0 disables the cache
+    static idx_t GetMemoryLimit(ClientContext &context);
+
+    //! Looks up the schema of a read, returns false on a miss or if the read expired
+    bool LookupRead(ClientContext &context, const string &spreadsheet_id, const string &key, vector<string> &names,
+                    vector<LogicalType> &types);
+
+    //! Caches the schema of a read that missed, its windows are cached as they are scanned
+    void StoreRead(ClientContext &context, const string &spreadsheet_id, const string &key, const string &sheet_name,
+                   const vector<string> &names, const vector<LogicalType> &types);
+
+    //! The cached rows of a window of the read, WINDOW_KEY identifying its ranges and projected columns. nullptr on a
+    //! miss.
+    shared_ptr<CachedWindow> LookupWindow(const string &spreadsheet_id, const string &key, const string &window_key);
+
+    //! Caches the rows of a window of a read, evicting the least recently used reads to stay under the memory limit.
+    //! Windows of reads that are no longer cached, or that do not fit, are dropped.
+    void StoreWindow(ClientContext &context, const string &spreadsheet_id, const string &key, const string &window_key,
+                     shared_ptr<CachedWindow> window);
+
+    //! Drops every cached read of the spreadsheet
+    void Invalidate(const string &spreadsheet_id);
+
+    //! Drops every cached read, and resets the hit and miss counts
+    void Clear();
+
+    //! A row of duckdb_gsheets_cache(), the counts are kept while the read is cached
+    struct EntryInfo {
+        string spreadsheet_id;
+        string sheet_name;
+        idx_t row_count;
+        idx_t memory_bytes;
+        idx_t hits;
+        idx_t misses;
+    };
+
+    vector<EntryInfo> GetEntries();
+
+private:
+    struct Entry {
+        string spreadsheet_id;
+        string sheet_name;
+        //! When the read was cached, in seconds since the Unix epoch
+        int64_t read_at = 0;
+        vector<string> names;
+        vector<LogicalType> types;
+        unordered_map<string, shared_ptr<CachedWindow>> windows;
+        idx_t row_count = 0;
+        idx_t memory_bytes = 0;
+        idx_t hits = 0;
+        idx_t misses = 0;
+        //! Position in lru
+        list<string>::iterator lru_position;
+    };
+
+    //! Drops a cached read along with its counts. The lock must be held.
+    void Erase(unordered_map<string, Entry>::iterator entry);
+    //! Evicts the least recently used reads other than KEEP until BYTES more fit under the limit, returns false if
+    //! they do not fit. The lock must be held.
+    bool MakeRoom(idx_t bytes, idx_t limit, const string &keep);
+
+    mutex lock;
+    unordered_map<string, Entry> entries;
+    //! Keys of the entries, most recently used first
+    list<string> lru;
+    idx_t memory_bytes = 0;
+};
+
+//! PRAGMA gsheets_cache_clear, drops every cached read_gsheet result, in memory and on disk
+void ClearSheetCachePragma(ClientContext &context, const FunctionParameters &parameters);
+
+//! duckdb_gsheets_cache(), lists the reads in the memory cache with their size and hit and miss counts
+unique_ptr<FunctionData> SheetCacheBind(ClientContext &context, TableFunctionBindInput &input,
+                                        vector<LogicalType> &return_types, vector<string> &names);
+
+unique_ptr<GlobalTableFunctionState> SheetCacheInitGlobal(ClientContext &context, TableFunctionInitInput &input);
+
+void SheetCacheFunction(ClientContext &context, TableFunctionInput &data_p, DataChunk &output);
+
+} // namespace duckdb
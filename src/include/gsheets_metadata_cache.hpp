@@ -0,0 +1,73 @@
+#pragma once
+
+#include "duckdb.hpp"
+#include "duckdb/common/mutex.hpp"
+#include "duckdb/function/pragma_function.hpp"
+#include "duckdb/main/client_context.hpp"
+#include "duckdb/storage/object_cache.hpp"
+#include "gsheets_utils.hpp"
+
+#include <chrono>
+
+namespace duckdb {
+
+//! Per-database cache of the sheet properties (sheet id, title and grid size) of spreadsheets, keyed by spreadsheet
+//! id and token, so that a token is only served the metadata it was able to read. Entries expire after
+//! gsheets_metadata_cache_ttl seconds, and are invalidated by writes to the spreadsheet.
+class SpreadsheetMetadataCache : public ObjectCacheEntry {
+public:
+    static constexpr const char *TTL_SETTING = "gsheets_metadata_cache_ttl";
+    static constexpr int64_t DEFAULT_TTL_SECONDS = 60;
+
+    static string ObjectType() {
+        return "gsheets_metadata_cache";
+    }
+
+    string GetObjectType() override {
+        return ObjectType();
+    }
+
+    //! The cache of the database the context belongs to
+    static SpreadsheetMetadataCache &Get(ClientContext &context);
+
+    //! The properties of every sheet of the spreadsheet, fetched if they are not cached or have expired
+    vector<SheetProperties> GetSheets(ClientContext &context, const string &spreadsheet_id, const string &token);
+
+    /**
+     * Gets the properties of a sheet from its sheet ID
+     * @throws InvalidInputException if the spreadsheet has no sheet with that ID
+     */
+    SheetProperties GetSheetById(ClientContext &context, const string &spreadsheet_id, const string &sheet_id,
+                                 const string &token);
+
+    /**
+     * Gets the properties of a sheet from its name
+     * @throws InvalidInputException if the spreadsheet has no sheet with that name
+     */
+    SheetProperties GetSheetByName(ClientContext &context, const string &spreadsheet_id, const string &sheet_name,
+                                   const string &token);
+
+    //! Drops the cached properties of the spreadsheet
+    void Invalidate(const string &spreadsheet_id);
+
+    //! Drops every cached spreadsheet
+    void Clear();
+
+private:
+    struct Entry {
+        string spreadsheet_id;
+        vector<SheetProperties> sheets;
+        std::chrono::steady_clock::time_point fetched_at;
+    };
+
+    mutex lock;
+    unordered_map<string, Entry> entries;
+};
+
+//! PRAGMA gsheets_cache_clear_metadata, drops every cached spreadsheet
+void ClearMetadataCachePragma(ClientContext &context, const FunctionParameters &parameters);
+
+//! PRAGMA gsheets_cache_clear_metadata('<url or id>'), drops the cached properties of one spreadsheet
+void ClearSpreadsheetMetadataCachePragma(ClientContext &context, const FunctionParameters &parameters);
+
+} // namespace duckdb
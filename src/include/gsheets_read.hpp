@@ -3,20 +3,162 @@
 #include "duckdb.hpp"
 #include "duckdb/function/table_function.hpp"
 #include "duckdb/common/types/data_chunk.hpp"
+#include "duckdb/common/types/column/column_data_collection.hpp"
+#include "duckdb/common/mutex.hpp"
 #include "duckdb/main/client_context.hpp"
+#include "gsheets_decoder.hpp"
+#include "gsheets_memory_cache.hpp"
+#include "gsheets_requests.hpp"
+
+#include <condition_variable>
+#include <future>
 
 namespace duckdb {
 
-struct ReadSheetBindData : public TableFunctionData {
+//! A sheet read by read_gsheet. A read covers one or more sheets, of one or more spreadsheets.
+struct SheetPart {
+    //! The URL or ID the spreadsheet was given as
+    string source;
     string spreadsheet_id;
+    //! The name of the sheet
+    string title;
+    //! The name of the sheet, quoted and URL encoded for use in ranges, so that names with spaces or quotes, or that
+    //! look like cells, are read by name
+    string sheet_name;
+    //! The last sheet row read, bounded by the sheet grid, the range and max_rows. Rows added to the sheet since its
+    //! grid size was fetched are read once the metadata cache entry expires.
+    idx_t last_row;
+    //! The last sheet column (0-based) read, bounded by the sheet grid and the range
+    idx_t last_column;
+};
+
+struct ReadSheetBindData : public TableFunctionData {
+    static constexpr idx_t DEFAULT_BATCH_ROWS = 5000;
+    //! Number of data rows the column types are sniffed from
+    static constexpr idx_t DEFAULT_SAMPLE_SIZE = 1000;
+
     string token;
-    bool finished;
-    idx_t row_index;
-    string response;
+    //! The rate limit and retries of the requests of the read, from the settings of the binding context
+    RequestSettings request_settings;
     bool header;
-    string sheet_name;
+    //! Number of sheet rows requested per window
+    idx_t batch_rows;
+    //! Whether windows grow beyond batch_rows as the request budget runs out, unless batch_rows is given
+    bool adaptive_batch_rows = true;
+    //! The first sheet row (1-based) read in every sheet, holding the header if there is one
+    idx_t first_row;
+    //! The first sheet column (0-based) read in every sheet
+    idx_t first_column;
+    //! The sheets read, their rows are returned one sheet after the other
+    vector<SheetPart> parts;
+    //! The types of the sheet columns, followed by those of the sheet_name and filename columns
+    vector<LogicalType> types;
+    //! The number of sheet columns
+    idx_t column_count = 0;
+    //! The columns holding the name of the sheet and the spreadsheet URL or ID of each row, or
+    //! DConstants::INVALID_INDEX if they are not read
+    idx_t sheet_name_column = DConstants::INVALID_INDEX;
+    idx_t filename_column = DConstants::INVALID_INDEX;
+    //! Query parameters choosing how values are rendered, empty for formatted values
+    string render_options;
+
+    //! The rows of a read cached on disk, nullptr if they are downloaded while scanning
+    shared_ptr<ColumnDataCollection> cached_rows;
+    //! The key of the read in the memory cache, which its windows are cached under as they are scanned. Empty if they
+    //! are not cached.
+    string cache_key;
+
+    ReadSheetBindData(string token, bool header);
+
+    //! The first sheet row (1-based) holding data
+    idx_t FirstDataRow() const;
+};
+
+//! Rows of a sheet read in a window
+struct SheetSlice {
+    //! The index of the sheet in the parts of the read
+    idx_t part;
+    //! The first and last sheet rows (1-based) of the slice
+    idx_t first_row;
+    idx_t last_row;
+};
+
+//! Rows of one or more sheets of a spreadsheet, fetched with a single values:batchGet. The unit of work handed out
+//! to scan threads.
+struct SheetWindow {
+    vector<SheetSlice> slices;
+    //! Position of the window in the read, used to preserve insertion order
+    idx_t batch_index;
+};
 
-    ReadSheetBindData(string spreadsheet_id, string token, bool header, string sheet_name);
+//! How far a window of the read has got. The API leaves out the empty rows a range ends in, so the rows of a slice
+//! start with the empty rows its sheet ended in before it, which are only known once the earlier slices are read.
+struct SheetWindowProgress {
+    //! The response of the window, from when it is requested until it is decoded
+    std::shared_future<HttpResponse> response;
+    //! Whether a thread is decoding the window
+    bool decoding = false;
+    //! Whether slice_rows is known
+    bool done = false;
+    //! For each slice, the rows from its first row to its last row holding a value, 0 if it holds none
+    vector<idx_t> slice_rows;
+    //! The key of the window in the memory cache, and its rows if the cache had them
+    string window_key;
+    shared_ptr<CachedWindow> cached;
+};
+
+struct ReadSheetGlobalState : public GlobalTableFunctionState {
+    explicit ReadSheetGlobalState(idx_t max_threads) : max_threads(max_threads) {
+    }
+
+    //! Output types, in the order of the projected column ids
+    vector<LogicalType> types;
+    //! The first and last sheet columns, relative to first_column, of each range requested per slice
+    vector<std::pair<idx_t, idx_t>> column_ranges;
+    //! Where the cells of each sheet column are decoded into. The ranges of a window are set up per window.
+    SheetColumnMapping mapping;
+    //! For each of the mapping's constant columns, the sheet_name or filename column it holds
+    vector<idx_t> constant_sources;
+    //! Whether every column is requested. Otherwise the rows below the last one holding a value in the requested
+    //! columns are looked up in every column once the last slice of a sheet is read.
+    bool all_columns = true;
+    //! Set when the rows are cached on disk: whole rows are scanned, and projected to the column ids
+    bool whole_rows = false;
+    vector<column_t> column_ids;
+    //! The projected column ids, which the windows cached in memory are kept apart by
+    string cached_columns;
+
+    mutex lock;
+    //! The windows of the read, in order, planned up to the grid size of every sheet
+    vector<SheetWindow> windows;
+    //! The next window to hand out
+    idx_t next_window = 0;
+    //! The progress of every window, by batch index. Threads waiting for a window to be decoded are woken by
+    //! progress_changed.
+    vector<SheetWindowProgress> progress;
+    std::condition_variable progress_changed;
+    idx_t max_threads;
+
+    idx_t MaxThreads() const override {
+        return max_threads;
+    }
+};
+
+struct ReadSheetLocalState : public LocalTableFunctionState {
+    //! The rows of the current window, decoded into the output types
+    shared_ptr<ColumnDataCollection> collection;
+    //! Whole rows scanned from the collection, before they are projected
+    DataChunk rows;
+    //! Cursor into the collection
+    ColumnDataScanState scan_state;
+    //! Batch index of the window being scanned
+    idx_t batch_index = 0;
+    //! The next window claimed by this thread, downloading while the current one is scanned
+    bool has_next = false;
+    SheetWindow next;
+    //! Where the cells of the next window are decoded into
+    SheetColumnMapping next_mapping;
+    std::shared_future<HttpResponse> next_window;
 };
 
 void ReadSheetFunction(ClientContext &context, TableFunctionInput &data_p, DataChunk &output);
@@ -24,4 +166,12 @@ void ReadSheetFunction(ClientContext &context, TableFunctionInput &data_p, DataC
 unique_ptr<FunctionData> ReadSheetBind(ClientContext &context, TableFunctionBindInput &input,
                                        vector<LogicalType> &return_types, vector<string> &names);
 
-} // namespace duckdb
\ No newline at end of file
+unique_ptr<GlobalTableFunctionState> ReadSheetInitGlobal(ClientContext &context, TableFunctionInitInput &input);
+
+unique_ptr<LocalTableFunctionState> ReadSheetInitLocal(ExecutionContext &context, TableFunctionInitInput &input,
+                                                       GlobalTableFunctionState *global_state);
+
+idx_t ReadSheetGetBatchIndex(ClientContext &context, const FunctionData *bind_data_p,
+                             LocalTableFunctionState *local_state, GlobalTableFunctionState *global_state);
+
+} // namespace duckdb
@@ -1,21 +1,216 @@
 #pragma once
 
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <future>
+#include <mutex>
 #include <string>
+#include <unordered_map>
+#include <vector>
 
 namespace duckdb {
 
+class ClientContext;
+
 enum class HttpMethod {
         GET,
         POST,
         PUT
     };
 
-std::string perform_https_request(const std::string& host, const std::string& path, const std::string& token, 
-                                  HttpMethod method = HttpMethod::GET, const std::string& body = "", const std::string& content_type = "application/json");
+struct HttpResponse {
+    //! The HTTP status code
+    int status = 0;
+    //! Response headers, keyed by lowercase name
+    std::unordered_map<std::string, std::string> headers;
+    std::string body;
+
+    bool IsSuccess() const {
+        return status >= 200 && status < 300;
+    }
+};
+
+/**
+ * Describes a failed response, using the message of a Google API error body when there is one
+ * @param response The failed response
+ * @return The status code followed by the error message
+ */
+std::string get_response_error(const HttpResponse& response);
+
+//! Requests per minute allowed per user by default, the default Sheets API quota of a user for reads, and for writes
+constexpr double DEFAULT_REQUESTS_PER_MINUTE = 60;
+constexpr int64_t DEFAULT_MAX_REQUEST_RETRIES = 5;
+
+//! How the requests of a query are rate limited and retried
+struct RequestSettings {
+    static constexpr const char *REQUESTS_PER_MINUTE_SETTING = "gsheets_requests_per_minute";
+    static constexpr const char *MAX_RETRIES_SETTING = "gsheets_max_retries";
+
+    //! Requests per minute allowed per user, for reads and for writes each. 0 disables rate limiting.
+    double requests_per_minute = DEFAULT_REQUESTS_PER_MINUTE;
+    //! How many times a throttled or failed request is retried
+    int64_t max_retries = DEFAULT_MAX_REQUEST_RETRIES;
+};
+
+//! The gsheets_requests_per_minute and gsheets_max_retries settings of the context
+RequestSettings GetRequestSettings(ClientContext &context);
+
+/**
+ * Token buckets limiting the requests of each user, keyed by a hash of the access token and by whether requests read or
+ * write, since the API counts reads and writes against separate per-minute quotas. A bucket holds a minute of requests:
+ * bursts go out at once, and sustained throughput stays just under the quota. A 429 pauses the whole bucket for as long
+ * as the server asked, not only the request that got it. The rate is passed with every call, so that each query is
+ * limited by its own setting; a bucket holds at most a minute of requests at the rate it is called with. A bucket idle
+ * for a minute is full again, the same as a new one, so it is dropped to keep tokens that are no longer used from
+ * piling up.
+ */
+class RequestRateLimiter {
+public:
+    typedef std::chrono::steady_clock::time_point time_point_t;
+    typedef std::function<time_point_t()> clock_function_t;
+    typedef std::function<void(std::chrono::steady_clock::duration)> sleep_function_t;
+
+    //! A limiter on the steady clock
+    RequestRateLimiter();
+    //! A limiter reading the time from CLOCK and waiting with SLEEP, which tests use to control time
+    RequestRateLimiter(clock_function_t clock, sleep_function_t sleep);
+
+    //! The limiter shared by the requests of the process
+    static RequestRateLimiter &Get();
+
+    //! Waits until the bucket has a request to spare, and takes it. A rate of 0 or less disables limiting.
+    void Acquire(const std::string& key, double requests_per_minute);
+
+    //! Holds back every request of the bucket for the delay
+    void Pause(const std::string& key, double requests_per_minute, std::chrono::milliseconds delay);
+
+    //! The fraction of the bucket left, 0 while it is empty or paused
+    double Headroom(const std::string& key, double requests_per_minute);
+
+    //! The number of buckets held
+    size_t BucketCount();
+
+    //! Waits with the sleep function of the limiter, e.g. for the backoff of a retried request
+    void Sleep(std::chrono::steady_clock::duration wait);
+
+private:
+    struct Bucket {
+        double tokens;
+        time_point_t last_refill;
+        time_point_t paused_until;
+    };
+
+    //! Adds the requests earned since the last refill, the lock must be held
+    Bucket &Refill(const std::string& key, double requests_per_minute, time_point_t now);
+    //! Drops the buckets that have been full for a minute, the lock must be held
+    void EvictIdle(time_point_t now);
+
+    clock_function_t clock;
+    sleep_function_t sleep;
+    std::mutex lock;
+    std::unordered_map<std::string, Bucket> buckets;
+    time_point_t last_eviction;
+};
+
+/**
+ * Whether a request that got the status can be sent again. 429 and 503 responses were not processed, other server
+ * errors may have been, so only requests that can be repeated safely are retried on them.
+ */
+bool is_retryable_status(int status, HttpMethod method);
+
+/**
+ * The delay before the next attempt of a request: what the Retry-After header of the response asks for (up to 300s),
+ * or else exponential backoff (1s, 2s, 4s, ... up to 64s) plus up to a second of jitter, so that throttled clients do
+ * not retry in lockstep
+ * @param response The response of the failed attempt, nullptr if it failed without one
+ * @param attempt The number of the failed attempt, from 0
+ */
+std::chrono::milliseconds get_retry_delay(const HttpResponse* response, int64_t attempt);
+
+//! Sends an attempt of a request
+typedef std::function<std::future<HttpResponse>()> send_attempt_t;
+
+/**
+ * Defers taking the response of the first attempt of a request: the returned future retries the request with
+ * send_attempt on 429 and 5xx responses and connection failures, up to max_retries times, on the thread that takes
+ * the response. The backoff between attempts waits with the sleep function of the limiter, and a 429 pauses the bucket
+ * of the limiter the request was counted against.
+ * @param key The bucket of the limiter the request is counted against
+ */
+std::future<HttpResponse> defer_retries(std::future<HttpResponse> first_attempt, send_attempt_t send_attempt,
+                                        const RequestSettings& settings, HttpMethod method, RequestRateLimiter& limiter,
+                                        const std::string& key);
+
+/**
+ * Queues a request on the process-wide request engine. At most a handful of requests per host are in flight at once,
+ * each on a kept-alive connection, the others wait in a queue. Requests are rate limited per user, the calling thread
+ * waits for the limit before the request is queued. Requests are retried with backoff on 429 and 5xx responses by the
+ * thread that takes the response from the future, so throttled requests never tie up the workers of the engine.
+ * @param settings The rate limit and retries of the query issuing the request
+ * @return The future response. Requests that fail to complete, e.g. on a connection error, throw an IOException
+ * from get().
+ */
+std::future<HttpResponse> submit_https_request(const std::string& host, const std::string& path, const std::string& token,
+                                               const RequestSettings& settings, HttpMethod method = HttpMethod::GET, const std::string& body = "", const std::string& content_type = "application/json");
+
+/**
+ * The factor batches of requests of the user should be grown by, 1 while most of the request budget is left, up to 4
+ * as it runs out, so that fewer and larger requests keep throughput under the quota
+ * @param method GET for reads, other methods for writes
+ */
+size_t get_batch_scale(const std::string& token, const RequestSettings& settings, HttpMethod method);
+
+//! Runs a request on the request engine and waits for its response
+HttpResponse perform_https_request(const std::string& host, const std::string& path, const std::string& token,
+                                  const RequestSettings& settings, HttpMethod method = HttpMethod::GET, const std::string& body = "", const std::string& content_type = "application/json");
+
+HttpResponse call_sheets_api(const std::string& spreadsheet_id, const std::string& token, const RequestSettings& settings, const std::string& sheet_name, HttpMethod method = HttpMethod::GET, const std::string& body = "");
+
+/**
+ * Gets the values of several ranges of a spreadsheet in a single request
+ * @param render_options Query parameters choosing how values are rendered, e.g. "&valueRenderOption=UNFORMATTED_VALUE"
+ */
+HttpResponse batch_get_sheet_values(const std::string& spreadsheet_id, const std::string& token, const RequestSettings& settings, const std::vector<std::string>& ranges, const std::string& render_options = "");
+
+std::future<HttpResponse> batch_get_sheet_values_async(const std::string& spreadsheet_id, const std::string& token, const RequestSettings& settings, const std::vector<std::string>& ranges, const std::string& render_options = "");
+
+/**
+ * Gets the effective value and number format type of every cell of a range, e.g. to tell dates from numbers
+ */
+HttpResponse get_sheet_cells(const std::string& spreadsheet_id, const std::string& token, const RequestSettings& settings, const std::string& range);
+
+std::future<HttpResponse> get_sheet_cells_async(const std::string& spreadsheet_id, const std::string& token, const RequestSettings& settings, const std::string& range);
+
+/**
+ * Writes the values of a range of a spreadsheet
+ * @param value_input_option USER_ENTERED to parse values as if typed into the sheet, RAW to store them as they are
+ */
+HttpResponse update_sheet_values(const std::string& spreadsheet_id, const std::string& token, const RequestSettings& settings, const std::string& range, const std::string& body, const std::string& value_input_option = "USER_ENTERED");
+
+std::future<HttpResponse> update_sheet_values_async(const std::string& spreadsheet_id, const std::string& token, const RequestSettings& settings, const std::string& range, const std::string& body, const std::string& value_input_option = "USER_ENTERED");
+
+/**
+ * Appends values below the table found in a range of a spreadsheet. The response tells the range that was written.
+ */
+HttpResponse append_sheet_values(const std::string& spreadsheet_id, const std::string& token, const RequestSettings& settings, const std::string& range, const std::string& body, const std::string& value_input_option = "USER_ENTERED");
+
+/**
+ * Writes the values of several ranges of a spreadsheet in a single values:batchUpdate request
+ * @param body The request body, e.g. {"valueInputOption": "USER_ENTERED", "data": [{"range": ..., "values": ...}]}
+ */
+std::future<HttpResponse> batch_update_sheet_values_async(const std::string& spreadsheet_id, const std::string& token, const RequestSettings& settings, const std::string& body);
+
+HttpResponse batch_update_spreadsheet(const std::string& spreadsheet_id, const std::string& token, const RequestSettings& settings, const std::string& body);
+
+std::future<HttpResponse> batch_update_spreadsheet_async(const std::string& spreadsheet_id, const std::string& token, const RequestSettings& settings, const std::string& body);
 
-std::string call_sheets_api(const std::string& spreadsheet_id, const std::string& token, const std::string& sheet_name, HttpMethod method = HttpMethod::GET, const std::string& body = "");
+HttpResponse delete_sheet_data(const std::string& spreadsheet_id, const std::string& token, const RequestSettings& settings, const std::string& sheet_name);
 
-std::string delete_sheet_data(const std::string& spreadsheet_id, const std::string& token, const std::string& sheet_name);
+HttpResponse get_spreadsheet_metadata(const std::string& spreadsheet_id, const std::string& token, const RequestSettings& settings);
 
-std::string get_spreadsheet_metadata(const std::string& spreadsheet_id, const std::string& token);
-}
\ No newline at end of file
+/**
+ * Gets fields of the Drive metadata of a file, e.g. the version of a spreadsheet. Needs a token with a Drive scope.
+ */
+HttpResponse get_drive_file(const std::string& file_id, const std::string& token, const RequestSettings& settings, const std::string& fields);
+}
@@ -9,6 +9,8 @@ using json = nlohmann::json;
 
 namespace duckdb {
 
+struct RequestSettings;
+
 /**
  * Extracts the sheet ID from a Google Sheets URL or returns the input if it's already a sheet ID.
  * @param input A Google Sheets URL or sheet ID
@@ -25,31 +27,32 @@ std::string extract_spreadsheet_id(const std::string& input);
  */
 std::string extract_sheet_id(const std::string& input);
 
+struct SheetProperties {
+    std::string sheet_id;
+    std::string title;
+    // Size of the sheet grid, including empty rows and columns
+    size_t row_count;
+    size_t column_count;
+};
+
 /**
- * Gets the sheet name from a spreadsheet ID and sheet ID
+ * Fetches the properties of every sheet of a spreadsheet in a single metadata request
  * @param spreadsheet_id The spreadsheet ID
- * @param sheet_id The sheet ID
  * @param token The Google API token
- * @return The sheet name
+ * @param settings The rate limit and retries of the request
+ * @return The properties of the sheets, in spreadsheet order
+ * @throws IOException if the metadata request fails
  */
-std::string get_sheet_name_from_id(const std::string& spreadsheet_id, const std::string& sheet_id, const std::string& token);
+std::vector<SheetProperties> get_spreadsheet_sheets(const std::string& spreadsheet_id, const std::string& token, const RequestSettings& settings);
 
 /**
- * Gets the sheet ID from a spreadsheet ID and sheet name
+ * Fetches the Drive version of a spreadsheet, which increases with every change to it
  * @param spreadsheet_id The spreadsheet ID
- * @param sheet_name The sheet name
  * @param token The Google API token
- * @return The sheet ID
+ * @param settings The rate limit and retries of the request
+ * @return The version, or an empty string if it could not be fetched, e.g. when the token has no Drive scope
  */
-std::string get_sheet_id_from_name(const std::string& spreadsheet_id, const std::string& sheet_name, const std::string& token);
-
-struct SheetData {
-    std::string range;
-    std::string majorDimension;
-    std::vector<std::vector<std::string>> values;
-};
-
-SheetData getSheetData(const json& j);
+std::string get_spreadsheet_version(const std::string& spreadsheet_id, const std::string& token, const RequestSettings& settings);
 
 /**
  * Parses a JSON string into a json object
@@ -66,6 +69,38 @@ json parseJson(const std::string& json_str);
 std::string generate_random_string(size_t length);
 
 
+struct SheetRange {
+    // Empty when the range does not name a sheet
+    std::string sheet_name;
+    // 1-based bounds of the range, 0 when unbounded
+    size_t first_row = 0;
+    size_t last_row = 0;
+    size_t first_column = 0;
+    size_t last_column = 0;
+};
+
+/**
+ * Parses a range in A1 notation, e.g. A1:C100, 'My Sheet'!B2:D, 2:500 or A:C
+ * @param range The range in A1 notation
+ * @return The bounds of the range, and the sheet name without its quotes, e.g. It's for 'It''s'!A1
+ * @throws InvalidInputException if the range is not valid A1 notation
+ */
+SheetRange parse_sheet_range(const std::string& range);
+
+/**
+ * Converts a zero-based column index to its A1 column letters, e.g. 0 -> A, 26 -> AA
+ * @param column_index The zero-based column index
+ * @return The column letters
+ */
+std::string column_index_to_letter(size_t column_index);
+
+/**
+ * Quotes a sheet name for use in an A1 range, e.g. It's -> 'It''s'
+ * @param sheet_name The sheet name
+ * @return The quoted sheet name
+ */
+std::string quote_sheet_name(const std::string& sheet_name);
+
 /**
  * Encodes a string to be used in a URL
  * @param str The string to encode
@@ -73,4 +108,12 @@ std::string generate_random_string(size_t length);
  */
 std::string url_encode(const std::string& str);
 
+/**
+ * Identifies the user of a token in cache keys, so that cached results are only served to the user they were read
+ * by, without keeping the token itself in the key
+ * @param token The Google API token
+ * @return A hash of the token
+ */
+std::string get_token_key(const std::string& token);
+
 } // namespace duckdb
\ No newline at end of file
@@ -0,0 +1,42 @@
+// Checks shared by the C++ unit tests. A failed check is reported and counted, and the test keeps going, so that one
+// run reports every failure.
+
+#pragma once
+
+#include <cstdio>
+#include <cstdlib>
+
+static int failures = 0;
+
+#define CHECK(condition)                                                                                               \
+    do {                                                                                                               \
+        if (!(condition)) {                                                                                            \
+            std::fprintf(stderr, "%s:%d: check failed: %s\n", __FILE__, __LINE__, #condition);                         \
+            failures++;                                                                                                \
+        }                                                                                                              \
+    } while (0)
+
+//! Checks that the statement throws EXCEPTION
+#define CHECK_THROWS(statement, exception)                                                                             \
+    do {                                                                                                               \
+        bool thrown = false;                                                                                           \
+        try {                                                                                                          \
+            statement;                                                                                                 \
+        } catch (exception &) {                                                                                        \
+            thrown = true;                                                                                             \
+        }                                                                                                              \
+        if (!thrown) {                                                                                                 \
+            std::fprintf(stderr, "%s:%d: did not throw %s: %s\n", __FILE__, __LINE__, #exception, #statement);         \
+            failures++;                                                                                                \
+        }                                                                                                              \
+    } while (0)
+
+//! The exit code of a test, reporting the number of failed checks
+static int FinishChecks() {
+    if (failures > 0) {
+        std::fprintf(stderr, "%d checks failed\n", failures);
+        return EXIT_FAILURE;
+    }
+    std::printf("All checks passed\n");
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,188 @@
+// Unit tests of the SAX decoder of values responses, fed canned responses as the Sheets API returns them: rows are
+// placed by the range of the response, short rows are padded, and cells that do not convert name where they are.
+// The SQL tests only see the rows of a live sheet. Built with -DGSHEETS_BUILD_UNIT_TESTS=ON and run by ctest.
+
+#include "gsheets_decoder.hpp"
+#include "test_check.hpp"
+
+#include "duckdb.hpp"
+#include "duckdb/common/error_data.hpp"
+#include "duckdb/common/exception.hpp"
+
+#include <limits>
+
+using namespace duckdb;
+
+//! The rows of the collection, each cell as its string value or NULL, e.g. {"Alice", "30", "NULL"}
+static vector<vector<string>> GetRows(ColumnDataCollection &collection) {
+    vector<vector<string>> result;
+    auto rows = collection.GetRows();
+    for (idx_t r = 0; r < rows.Count(); r++) {
+        vector<string> row;
+        for (idx_t c = 0; c < collection.ColumnCount(); c++) {
+            auto value = rows.GetValue(c, r);
+            row.push_back(value.IsNull() ? "NULL" : value.ToString());
+        }
+        result.push_back(std::move(row));
+    }
+    return result;
+}
+
+//! A mapping of one range of the first width sheet columns, each into the output column of the same index,
+//! requested from first_row of Sheet1
+static SheetColumnMapping SingleRangeMapping(idx_t width, idx_t first_row) {
+    SheetColumnMapping mapping;
+    mapping.range_columns = {0};
+    mapping.range_widths = {width};
+    for (idx_t col = 0; col < width; col++) {
+        mapping.output_columns.push_back(col);
+    }
+    mapping.range_first_rows = {first_row};
+    mapping.range_first_columns = {0};
+    mapping.part_sheets = {"Sheet1"};
+    return mapping;
+}
+
+//! The message of the conversion error thrown decoding the response, empty if none is
+static string GetConversionError(ClientContext &context, const string &response, const SheetColumnMapping &mapping,
+                                 const vector<LogicalType> &types) {
+    ColumnDataCollection collection(context, types);
+    try {
+        DecodeSheetValues(context, response, mapping, collection);
+    } catch (ConversionException &ex) {
+        return ErrorData(ex).RawMessage();
+    }
+    return string();
+}
+
+static void TestPadding(ClientContext &context) {
+    // Trailing empty cells and empty rows are omitted from the response
+    string response = R"({"range": "Sheet1!A2:C5", "majorDimension": "ROWS", "values": [)"
+                      R"(["Alice", "30", "Toronto"], ["Bob"], [], ["Archie", "99"]]})";
+    ColumnDataCollection collection(context, {LogicalType::VARCHAR, LogicalType::BIGINT, LogicalType::VARCHAR});
+    vector<idx_t> part_rows;
+    CHECK(DecodeSheetValues(context, response, SingleRangeMapping(3, 2), collection, &part_rows) == 4);
+    vector<vector<string>> expected = {
+        {"Alice", "30", "Toronto"}, {"Bob", "NULL", "NULL"}, {"NULL", "NULL", "NULL"}, {"Archie", "99", "NULL"}};
+    CHECK(GetRows(collection) == expected);
+    CHECK(part_rows == vector<idx_t>({4}));
+}
+
+static void TestRangeOffset(ClientContext &context) {
+    // Rows 2 and 3 are empty, the response range starts at the first row holding values
+    string response = R"({"spreadsheetId": "id", "valueRanges": [{"range": "Sheet1!A4:C5", "majorDimension": "ROWS",)"
+                      R"( "values": [["Carol", "41", "Oslo"], ["Dan", "7", "Lima"]]}]})";
+    auto mapping = SingleRangeMapping(3, 2);
+    mapping.part_leading_rows = {1};
+    mapping.part_trailing_rows = {2};
+    ColumnDataCollection collection(context, {LogicalType::VARCHAR, LogicalType::BIGINT, LogicalType::VARCHAR});
+    vector<idx_t> part_rows;
+    CHECK(DecodeSheetValues(context, response, mapping, collection, &part_rows) == 7);
+    vector<vector<string>> expected = {{"NULL", "NULL", "NULL"},  {"NULL", "NULL", "NULL"},
+                                       {"NULL", "NULL", "NULL"},  {"Carol", "41", "Oslo"},
+                                       {"Dan", "7", "Lima"},      {"NULL", "NULL", "NULL"},
+                                       {"NULL", "NULL", "NULL"}};
+    CHECK(GetRows(collection) == expected);
+    // The leading and trailing rows are not rows of the sheet
+    CHECK(part_rows == vector<idx_t>({4}));
+    CHECK(DecodeSheetExtents(response, mapping) == vector<idx_t>({4}));
+}
+
+//! Sheets A:B of Sheet1, Sheet2 and Sheet3 stacked, with the sheet name as the first output column
+static SheetColumnMapping ThreeSheetMapping() {
+    SheetColumnMapping mapping;
+    mapping.range_columns = {0, 0, 0};
+    mapping.range_widths = {2, 2, 2};
+    mapping.range_parts = {0, 1, 2};
+    mapping.output_columns = {1, 2};
+    mapping.constant_columns = {0};
+    mapping.part_constants = {{"Sheet1"}, {"Sheet2"}, {"Sheet3"}};
+    mapping.range_first_rows = {2, 2, 2};
+    mapping.range_first_columns = {0, 0, 0};
+    mapping.part_sheets = {"Sheet1", "Sheet2", "Sheet3"};
+    mapping.part_trailing_rows = {1, 0, 2};
+    return mapping;
+}
+
+static void TestConstantColumns(ClientContext &context) {
+    // Sheet3 has no rows holding values, only its trailing rows are decoded
+    string response = R"({"spreadsheetId": "id", "valueRanges": [)"
+                      R"({"range": "Sheet1!A2:B3", "majorDimension": "ROWS", "values": [["a", "1"], ["b", "2"]]},)"
+                      R"({"range": "Sheet2!A2:B2", "majorDimension": "ROWS", "values": [["c", "3"]]},)"
+                      R"({"range": "Sheet3!A2:B1000", "majorDimension": "ROWS"}]})";
+    auto mapping = ThreeSheetMapping();
+    ColumnDataCollection collection(context, {LogicalType::VARCHAR, LogicalType::VARCHAR, LogicalType::BIGINT});
+    vector<idx_t> part_rows;
+    CHECK(DecodeSheetValues(context, response, mapping, collection, &part_rows) == 6);
+    vector<vector<string>> expected = {{"Sheet1", "a", "1"},       {"Sheet1", "b", "2"},
+                                       {"Sheet1", "NULL", "NULL"}, {"Sheet2", "c", "3"},
+                                       {"Sheet3", "NULL", "NULL"}, {"Sheet3", "NULL", "NULL"}};
+    CHECK(GetRows(collection) == expected);
+    CHECK(part_rows == vector<idx_t>({2, 1, 0}));
+    CHECK(DecodeSheetExtents(response, mapping) == vector<idx_t>({2, 1, 0}));
+}
+
+static void TestSerialNumbers(ClientContext &context) {
+    // An unformatted response holds dates and times as serial numbers, days since 1899-12-30
+    string response = R"({"range": "Sheet1!A2:D3", "majorDimension": "ROWS", "values": [)"
+                      R"([45292, 45292.5, 1.5, true], ["2024-02-03", "2024-02-03 04:05:06", "2.25", "FALSE"]]})";
+    ColumnDataCollection collection(
+        context, {LogicalType::DATE, LogicalType::TIMESTAMP, LogicalType::DOUBLE, LogicalType::BOOLEAN});
+    CHECK(DecodeSheetValues(context, response, SingleRangeMapping(4, 2), collection) == 2);
+    vector<vector<string>> expected = {{"2024-01-01", "2024-01-01 12:00:00", "1.5", "true"},
+                                       {"2024-02-03", "2024-02-03 04:05:06", "2.25", "false"}};
+    CHECK(GetRows(collection) == expected);
+
+    date_t date;
+    CHECK(SheetSerialToDate(1, date) && date == Date::FromDate(1899, 12, 31));
+    CHECK(SheetSerialToDate(-0.5, date) && date == Date::FromDate(1899, 12, 29));
+    CHECK(!SheetSerialToDate(1e12, date));
+    CHECK(!SheetSerialToDate(std::numeric_limits<double>::quiet_NaN(), date));
+    timestamp_t timestamp;
+    CHECK(SheetSerialToTimestamp(45292.25, timestamp) &&
+          timestamp == Timestamp::FromDatetime(Date::FromDate(2024, 1, 1), dtime_t(6 * Interval::MICROS_PER_HOUR)));
+    CHECK(!SheetSerialToTimestamp(-1e12, timestamp));
+}
+
+static void TestConversionErrors(ClientContext &context) {
+    // The range starts 3 rows below the requested row 2, the second row is sheet row 6
+    string response = R"({"range": "Sheet1!A5:B6", "majorDimension": "ROWS", "values": [["x", "1"], ["y", "ten"]]})";
+    auto mapping = SingleRangeMapping(2, 2);
+    // Parsed straight into a BIGINT vector
+    auto error = GetConversionError(context, response, mapping, {LogicalType::VARCHAR, LogicalType::BIGINT});
+    CHECK(error.find("cell B6 of sheet 'Sheet1' with value \"ten\" to BIGINT") != string::npos);
+    // Staged as strings and cast once the response is read
+    error = GetConversionError(context, response, mapping, {LogicalType::VARCHAR, LogicalType::INTEGER});
+    CHECK(error.find("cell B6 of sheet 'Sheet1' with value \"ten\" to INTEGER") != string::npos);
+    // Serial numbers out of the range of dates
+    string serial = R"({"range": "Sheet1!C2", "majorDimension": "ROWS", "values": [[1e300]]})";
+    mapping.range_first_columns = {2};
+    error = GetConversionError(context, serial, mapping, {LogicalType::DATE, LogicalType::VARCHAR});
+    CHECK(error.find("cell C2 of sheet 'Sheet1'") != string::npos);
+}
+
+static void TestInvalidResponses(ClientContext &context) {
+    auto mapping = SingleRangeMapping(1, 1);
+    ColumnDataCollection collection(context, {LogicalType::VARCHAR});
+    string api_error = R"({"error": {"code": 403, "message": "The caller does not have permission",)"
+                       R"( "status": "PERMISSION_DENIED"}})";
+    CHECK_THROWS(DecodeSheetValues(context, api_error, mapping, collection), IOException);
+    CHECK_THROWS(DecodeSheetExtents(api_error, mapping), IOException);
+    CHECK_THROWS(DecodeSheetValues(context, R"({"values": [["a"}, {"b"]})", mapping, collection), IOException);
+    // More ranges than were requested
+    string ranges = R"({"valueRanges": [{"values": [["a"]]}, {"values": [["b"]]}]})";
+    CHECK_THROWS(DecodeSheetValues(context, ranges, mapping, collection), IOException);
+}
+
+int main() {
+    DuckDB db(nullptr);
+    Connection con(db);
+    auto &context = *con.context;
+    TestPadding(context);
+    TestRangeOffset(context);
+    TestConstantColumns(context);
+    TestSerialNumbers(context);
+    TestConversionErrors(context);
+    TestInvalidResponses(context);
+    return FinishChecks();
+}
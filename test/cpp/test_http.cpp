@@ -0,0 +1,193 @@
+// Unit tests of the HTTP/1.1 response parser and the gzip decompressor, fed canned responses a piece at a time as a
+// connection would deliver them. Built with -DGSHEETS_BUILD_UNIT_TESTS=ON and run by ctest.
+
+#include "gsheets_http.hpp"
+#include "test_check.hpp"
+
+#include "duckdb/common/exception.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <string>
+#include <zlib.h>
+
+using namespace duckdb;
+
+//! Feeds the bytes in pieces of at most piece bytes, returns whether the parser took them as a whole response
+static bool FeedInPieces(HttpResponseParser &parser, const std::string &bytes, size_t piece) {
+    bool done = false;
+    for (size_t pos = 0; pos < bytes.size() && !done; pos += piece) {
+        done = parser.Feed(bytes.data() + pos, std::min(piece, bytes.size() - pos));
+    }
+    return done;
+}
+
+static std::string Gzip(const std::string &data) {
+    z_stream stream;
+    memset(&stream, 0, sizeof(stream));
+    // 16 + MAX_WBITS writes the gzip wrapper
+    deflateInit2(&stream, Z_DEFAULT_COMPRESSION, Z_DEFLATED, 16 + MAX_WBITS, 8, Z_DEFAULT_STRATEGY);
+    std::string out(deflateBound(&stream, data.size()), '\0');
+    stream.next_in = reinterpret_cast<Bytef *>(const_cast<char *>(data.data()));
+    stream.avail_in = static_cast<uInt>(data.size());
+    stream.next_out = reinterpret_cast<Bytef *>(&out[0]);
+    stream.avail_out = static_cast<uInt>(out.size());
+    deflate(&stream, Z_FINISH);
+    out.resize(stream.total_out);
+    deflateEnd(&stream);
+    return out;
+}
+
+static void TestContentLength() {
+    std::string bytes = "HTTP/1.1 200 OK\r\nContent-Type: application/json\r\nContent-Length: 11\r\n\r\n{\"a\": true}";
+    // Whatever the pieces the bytes arrive in
+    for (size_t piece : {size_t(1), size_t(3), size_t(16), bytes.size()}) {
+        HttpResponse response;
+        HttpResponseParser parser(response);
+        CHECK(FeedInPieces(parser, bytes, piece));
+        CHECK(response.status == 200);
+        CHECK(response.body == "{\"a\": true}");
+        CHECK(response.headers["content-type"] == "application/json");
+        CHECK(parser.KeepAlive());
+    }
+
+    // A body cut short is not a response
+    HttpResponse response;
+    HttpResponseParser parser(response);
+    CHECK(!parser.Feed(bytes.data(), bytes.size() - 1));
+    CHECK(!parser.Finish());
+}
+
+static void TestChunked() {
+    std::string bytes = "HTTP/1.1 200 OK\r\nTransfer-Encoding: chunked\r\n\r\n"
+                        "5;name=value\r\nhello\r\n6\r\n world\r\n0\r\nX-Trailer: skipped\r\n\r\n";
+    for (size_t piece : {size_t(1), size_t(7), bytes.size()}) {
+        HttpResponse response;
+        HttpResponseParser parser(response);
+        CHECK(FeedInPieces(parser, bytes, piece));
+        CHECK(response.body == "hello world");
+        CHECK(response.headers.count("x-trailer") == 0);
+    }
+
+    HttpResponse response;
+    HttpResponseParser parser(response);
+    std::string invalid = "HTTP/1.1 200 OK\r\nTransfer-Encoding: chunked\r\n\r\nzz\r\n";
+    CHECK_THROWS(parser.Feed(invalid.data(), invalid.size()), IOException);
+}
+
+static void TestInterimResponses() {
+    // Interim responses are skipped, along with their headers
+    std::string bytes = "HTTP/1.1 100 Continue\r\nX-Interim: 1\r\n\r\n"
+                        "HTTP/1.1 102 Processing\r\n\r\n"
+                        "HTTP/1.1 201 Created\r\nContent-Length: 2\r\n\r\nok";
+    HttpResponse response;
+    HttpResponseParser parser(response);
+    CHECK(FeedInPieces(parser, bytes, 5));
+    CHECK(response.status == 201);
+    CHECK(response.body == "ok");
+    CHECK(response.headers.count("x-interim") == 0);
+
+    // 204 has no body
+    std::string no_content = "HTTP/1.1 204 No Content\r\n\r\n";
+    HttpResponse empty;
+    HttpResponseParser empty_parser(empty);
+    CHECK(empty_parser.Feed(no_content.data(), no_content.size()));
+    CHECK(empty.status == 204);
+    CHECK(empty.body.empty());
+}
+
+static void TestConnectionReuse() {
+    // Repeated headers are joined
+    std::string bytes = "HTTP/1.1 200 OK\r\nVary: Origin\r\nVary: X-Origin\r\nConnection: close\r\nContent-Length: 0\r\n\r\n";
+    HttpResponse response;
+    HttpResponseParser parser(response);
+    CHECK(parser.Feed(bytes.data(), bytes.size()));
+    CHECK(response.headers["vary"] == "Origin, X-Origin");
+    CHECK(!parser.KeepAlive());
+
+    // HTTP/1.0 connections are closed unless asked otherwise
+    std::string http10 = "HTTP/1.0 200 OK\r\nContent-Length: 0\r\n\r\n";
+    HttpResponse response10;
+    HttpResponseParser parser10(response10);
+    CHECK(parser10.Feed(http10.data(), http10.size()));
+    CHECK(!parser10.KeepAlive());
+
+    // Without framing the body runs until the connection closes
+    std::string unframed = "HTTP/1.1 200 OK\r\n\r\nuntil close";
+    HttpResponse until_close;
+    HttpResponseParser close_parser(until_close);
+    CHECK(!close_parser.Feed(unframed.data(), unframed.size()));
+    CHECK(close_parser.Finish());
+    CHECK(until_close.body == "until close");
+    CHECK(!close_parser.KeepAlive());
+
+    std::string invalid = "HTTP/1.1 200 OK\r\nContent-Length: -1\r\n\r\n";
+    HttpResponse invalid_response;
+    HttpResponseParser invalid_parser(invalid_response);
+    CHECK_THROWS(invalid_parser.Feed(invalid.data(), invalid.size()), IOException);
+}
+
+static void TestGzipInflater() {
+    std::string text;
+    for (int i = 0; i < 2000; i++) {
+        text += "{\"range\": \"Sheet1!A" + std::to_string(i) + "\"},";
+    }
+    auto compressed = Gzip(text);
+    CHECK(compressed.size() < text.size());
+
+    for (size_t piece : {size_t(1), size_t(100), compressed.size()}) {
+        GzipInflater inflater;
+        std::string out;
+        for (size_t pos = 0; pos < compressed.size(); pos += piece) {
+            CHECK(!inflater.Finished());
+            inflater.Inflate(compressed.data() + pos, std::min(piece, compressed.size() - pos), out);
+        }
+        CHECK(inflater.Finished());
+        CHECK(out == text);
+    }
+
+    GzipInflater corrupt;
+    std::string out;
+    std::string garbage = "not gzip at all";
+    CHECK_THROWS(corrupt.Inflate(garbage.data(), garbage.size(), out), IOException);
+}
+
+static void TestGzipResponses() {
+    std::string text = "{\"values\": [[\"a\", \"b\"], [\"c\"]]}";
+    auto compressed = Gzip(text);
+
+    // Chunked and gzip encoded, as the Sheets API sends large responses
+    std::string bytes = "HTTP/1.1 200 OK\r\nContent-Encoding: gzip\r\nTransfer-Encoding: chunked\r\n\r\n";
+    size_t half = compressed.size() / 2;
+    char size[32];
+    snprintf(size, sizeof(size), "%zx\r\n", half);
+    bytes += size + compressed.substr(0, half) + "\r\n";
+    snprintf(size, sizeof(size), "%zx\r\n", compressed.size() - half);
+    bytes += size + compressed.substr(half) + "\r\n0\r\n\r\n";
+    HttpResponse response;
+    HttpResponseParser parser(response);
+    CHECK(FeedInPieces(parser, bytes, 9));
+    CHECK(response.body == text);
+
+    // A response ending before the end of the gzip stream is truncated
+    std::string truncated = "HTTP/1.1 200 OK\r\nContent-Encoding: gzip\r\nContent-Length: " +
+                            std::to_string(half) + "\r\n\r\n" + compressed.substr(0, half);
+    HttpResponse truncated_response;
+    HttpResponseParser truncated_parser(truncated_response);
+    CHECK_THROWS(truncated_parser.Feed(truncated.data(), truncated.size()), IOException);
+
+    std::string unsupported = "HTTP/1.1 200 OK\r\nContent-Encoding: br\r\nContent-Length: 1\r\n\r\nx";
+    HttpResponse unsupported_response;
+    HttpResponseParser unsupported_parser(unsupported_response);
+    CHECK_THROWS(unsupported_parser.Feed(unsupported.data(), unsupported.size()), IOException);
+}
+
+int main() {
+    TestContentLength();
+    TestChunked();
+    TestInterimResponses();
+    TestConnectionReuse();
+    TestGzipInflater();
+    TestGzipResponses();
+    return FinishChecks();
+}
@@ -0,0 +1,237 @@
+// Unit tests of the request rate limiter and retry policy, which the SQL tests cannot reach: they would need a server
+// answering 429. Attempts are stand-in futures and time is a fake clock, so nothing goes over the network and no
+// check depends on timing. Built with -DGSHEETS_BUILD_UNIT_TESTS=ON and run by ctest.
+
+#include "gsheets_requests.hpp"
+#include "test_check.hpp"
+
+#include "duckdb/common/exception.hpp"
+
+#include <chrono>
+#include <functional>
+#include <future>
+#include <vector>
+
+using namespace duckdb;
+
+static HttpResponse ResponseWithRetryAfter(int status, const std::string &retry_after) {
+    HttpResponse response;
+    response.status = status;
+    response.headers["retry-after"] = retry_after;
+    return response;
+}
+
+//! A clock that only moves when the limiter sleeps, so that its waits are exact
+struct FakeClock {
+    RequestRateLimiter::time_point_t now;
+    std::chrono::steady_clock::duration slept {0};
+
+    //! Called before the clock moves on, e.g. to look at the limiter while a request backs off
+    std::function<void()> on_sleep;
+
+    void Sleep(std::chrono::steady_clock::duration wait) {
+        if (on_sleep) {
+            on_sleep();
+        }
+        now += wait;
+        slept += wait;
+    }
+};
+
+static std::chrono::milliseconds TimeAcquire(FakeClock &clock, RequestRateLimiter &limiter, const std::string &key,
+                                             double rate) {
+    clock.slept = std::chrono::steady_clock::duration(0);
+    limiter.Acquire(key, rate);
+    return std::chrono::duration_cast<std::chrono::milliseconds>(clock.slept);
+}
+
+static void TestRetryableStatus() {
+    for (auto method : {HttpMethod::GET, HttpMethod::POST, HttpMethod::PUT}) {
+        CHECK(is_retryable_status(429, method));
+        CHECK(is_retryable_status(503, method));
+        CHECK(!is_retryable_status(200, method));
+        CHECK(!is_retryable_status(400, method));
+        CHECK(!is_retryable_status(404, method));
+    }
+    // Server errors may have been processed, only requests that can be repeated are retried
+    CHECK(is_retryable_status(500, HttpMethod::GET));
+    CHECK(is_retryable_status(502, HttpMethod::PUT));
+    CHECK(!is_retryable_status(500, HttpMethod::POST));
+    CHECK(!is_retryable_status(504, HttpMethod::POST));
+}
+
+static void TestRetryDelay() {
+    // Retry-After is honored, up to 300s
+    auto response = ResponseWithRetryAfter(429, "7");
+    CHECK(get_retry_delay(&response, 0) == std::chrono::seconds(7));
+    CHECK(get_retry_delay(&response, 4) == std::chrono::seconds(7));
+    response = ResponseWithRetryAfter(429, "100000");
+    CHECK(get_retry_delay(&response, 0) == std::chrono::seconds(300));
+
+    // The HTTP date form, and responses without the header, fall back to backoff with up to a second of jitter
+    response = ResponseWithRetryAfter(503, "Wed, 21 Oct 2015 07:28:00 GMT");
+    auto delay = get_retry_delay(&response, 0);
+    CHECK(delay >= std::chrono::seconds(1) && delay < std::chrono::seconds(2));
+    for (int64_t attempt = 0; attempt < 6; attempt++) {
+        delay = get_retry_delay(nullptr, attempt);
+        CHECK(delay >= std::chrono::milliseconds(1000LL << attempt));
+        CHECK(delay < std::chrono::milliseconds((1000LL << attempt) + 1000));
+    }
+    // Backoff stops growing at 64s
+    CHECK(get_retry_delay(nullptr, 6) == std::chrono::seconds(64));
+    CHECK(get_retry_delay(nullptr, 40) == std::chrono::seconds(64));
+}
+
+static void TestRateLimiter() {
+    FakeClock clock;
+    RequestRateLimiter limiter([&clock]() { return clock.now; },
+                               [&clock](std::chrono::steady_clock::duration wait) { clock.Sleep(wait); });
+
+    // A rate of 0 disables limiting
+    CHECK(limiter.Headroom("off", 0) == 1);
+    for (int i = 0; i < 1000; i++) {
+        limiter.Acquire("off", 0);
+    }
+    CHECK(clock.slept.count() == 0);
+
+    // A bucket starts with a minute of requests, which go out at once
+    double rate = 600;
+    CHECK(limiter.Headroom("read a", rate) == 1);
+    for (int i = 0; i < 300; i++) {
+        limiter.Acquire("read a", rate);
+    }
+    CHECK(limiter.Headroom("read a", rate) == 0.5);
+
+    // Once it is empty, requests go out at the rate, one per 100ms here
+    for (int i = 0; i < 300; i++) {
+        limiter.Acquire("read a", rate);
+    }
+    CHECK(clock.slept.count() == 0);
+    CHECK(limiter.Headroom("read a", rate) == 0);
+    CHECK(TimeAcquire(clock, limiter, "read a", rate) == std::chrono::milliseconds(100));
+    clock.now += std::chrono::milliseconds(50);
+    CHECK(TimeAcquire(clock, limiter, "read a", rate) == std::chrono::milliseconds(50));
+
+    // Buckets are independent
+    CHECK(TimeAcquire(clock, limiter, "write a", rate).count() == 0);
+    CHECK(TimeAcquire(clock, limiter, "read b", rate).count() == 0);
+
+    // A 429 pauses the whole bucket, even while it has requests to spare
+    limiter.Pause("read b", rate, std::chrono::milliseconds(300));
+    CHECK(limiter.Headroom("read b", rate) == 0);
+    CHECK(TimeAcquire(clock, limiter, "read b", rate) == std::chrono::milliseconds(300));
+    CHECK(limiter.Headroom("read b", rate) > 0.9);
+    CHECK(TimeAcquire(clock, limiter, "write a", rate).count() == 0);
+
+    // Pauses only extend, a shorter one does not cut a longer one short
+    limiter.Pause("write b", rate, std::chrono::milliseconds(300));
+    limiter.Pause("write b", rate, std::chrono::milliseconds(1));
+    CHECK(TimeAcquire(clock, limiter, "write b", rate) == std::chrono::milliseconds(300));
+
+    // Buckets idle for a minute are full again, and are dropped, unless they are paused
+    CHECK(limiter.BucketCount() == 4);
+    clock.now += std::chrono::seconds(59);
+    limiter.Acquire("write b", rate);
+    CHECK(limiter.BucketCount() == 4);
+    clock.now += std::chrono::seconds(2);
+    limiter.Pause("read a", rate, std::chrono::seconds(90));
+    CHECK(limiter.BucketCount() == 2);
+    clock.now += std::chrono::seconds(60);
+    CHECK(limiter.Headroom("read c", rate) == 1);
+    CHECK(limiter.BucketCount() == 2);
+    CHECK(limiter.Headroom("read a", rate) == 0);
+}
+
+static std::future<HttpResponse> Attempt(int status, const std::string &retry_after = "") {
+    std::promise<HttpResponse> promise;
+    auto response = ResponseWithRetryAfter(status, retry_after);
+    if (retry_after.empty()) {
+        response.headers.clear();
+    }
+    promise.set_value(response);
+    return promise.get_future();
+}
+
+static std::future<HttpResponse> FailedAttempt() {
+    std::promise<HttpResponse> promise;
+    promise.set_exception(std::make_exception_ptr(IOException("Connection reset")));
+    return promise.get_future();
+}
+
+//! Sends the queued attempts in order, counting them
+struct AttemptQueue {
+    std::vector<std::function<std::future<HttpResponse>()>> attempts;
+    size_t sent = 0;
+
+    send_attempt_t Sender() {
+        return [this]() { return attempts[sent++](); };
+    }
+};
+
+static void TestDeferredRetries() {
+    FakeClock clock;
+    RequestRateLimiter limiter([&clock]() { return clock.now; },
+                               [&clock](std::chrono::steady_clock::duration wait) { clock.Sleep(wait); });
+    RequestSettings settings;
+    settings.requests_per_minute = 600;
+    settings.max_retries = 3;
+
+    // Nothing is retried until the response is taken, then the retries run on the taking thread, waiting what the
+    // responses ask for
+    AttemptQueue queue;
+    queue.attempts.push_back([]() { return Attempt(503, "1"); });
+    queue.attempts.push_back([]() { return Attempt(200); });
+    auto response = defer_retries(Attempt(429, "2"), queue.Sender(), settings, HttpMethod::GET, limiter, "read a");
+    CHECK(response.wait_for(std::chrono::seconds(0)) == std::future_status::deferred);
+    CHECK(queue.sent == 0);
+    CHECK(clock.slept.count() == 0);
+    CHECK(response.get().status == 200);
+    CHECK(queue.sent == 2);
+    CHECK(clock.slept == std::chrono::seconds(3));
+
+    // A 429 pauses the bucket the request was counted against while the request backs off
+    bool paused = false;
+    clock.on_sleep = [&]() { paused = limiter.Headroom("read b", settings.requests_per_minute) == 0; };
+    queue = AttemptQueue();
+    queue.attempts.push_back([]() { return Attempt(200); });
+    CHECK(defer_retries(Attempt(429, "5"), queue.Sender(), settings, HttpMethod::GET, limiter, "read b").get().status ==
+          200);
+    CHECK(paused);
+    clock.on_sleep = nullptr;
+
+    // Retries stop after max_retries, the last response is returned
+    settings.max_retries = 1;
+    queue = AttemptQueue();
+    queue.attempts.push_back([]() { return Attempt(503, "1"); });
+    CHECK(defer_retries(Attempt(503, "1"), queue.Sender(), settings, HttpMethod::GET, limiter, "read a").get().status ==
+          503);
+    CHECK(queue.sent == 1);
+
+    // Server errors that may have been processed are not retried for requests that cannot be repeated
+    settings.max_retries = 3;
+    queue = AttemptQueue();
+    CHECK(defer_retries(Attempt(500), queue.Sender(), settings, HttpMethod::POST, limiter, "write a").get().status ==
+          500);
+    CHECK(queue.sent == 0);
+
+    // Connection failures are retried with backoff, unless the request cannot be repeated
+    clock.slept = std::chrono::steady_clock::duration(0);
+    queue = AttemptQueue();
+    queue.attempts.push_back([]() { return Attempt(200); });
+    CHECK(defer_retries(FailedAttempt(), queue.Sender(), settings, HttpMethod::PUT, limiter, "write a").get().status ==
+          200);
+    CHECK(queue.sent == 1);
+    CHECK(clock.slept >= std::chrono::seconds(1) && clock.slept < std::chrono::seconds(2));
+    queue = AttemptQueue();
+    auto failed = defer_retries(FailedAttempt(), queue.Sender(), settings, HttpMethod::POST, limiter, "write a");
+    CHECK_THROWS(failed.get(), IOException);
+    CHECK(queue.sent == 0);
+}
+
+int main() {
+    TestRetryableStatus();
+    TestRetryDelay();
+    TestRateLimiter();
+    TestDeferredRetries();
+    return FinishChecks();
+}
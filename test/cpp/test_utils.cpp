@@ -0,0 +1,51 @@
+// Unit tests of the A1 range helpers: ranges named by the API, e.g. the range of a values response, are parsed back
+// into the sheet name and bounds they were built from. Built with -DGSHEETS_BUILD_UNIT_TESTS=ON and run by ctest.
+
+#include "gsheets_utils.hpp"
+#include "test_check.hpp"
+
+#include "duckdb/common/exception.hpp"
+
+#include <string>
+
+using namespace duckdb;
+
+static void TestParseRange() {
+    auto range = parse_sheet_range("A1:C100");
+    CHECK(range.sheet_name.empty());
+    CHECK(range.first_row == 1 && range.last_row == 100);
+    CHECK(range.first_column == 1 && range.last_column == 3);
+
+    range = parse_sheet_range("'My Sheet'!B2:D");
+    CHECK(range.sheet_name == "My Sheet");
+    CHECK(range.first_row == 2 && range.last_row == 0);
+    CHECK(range.first_column == 2 && range.last_column == 4);
+
+    range = parse_sheet_range("Sheet1!C7");
+    CHECK(range.sheet_name == "Sheet1");
+    CHECK(range.first_row == 7 && range.last_row == 7);
+
+    CHECK_THROWS(parse_sheet_range("Sheet1!C7:A1"), InvalidInputException);
+}
+
+static void TestQuotedSheetNames() {
+    // Quotes within a quoted name are doubled
+    auto range = parse_sheet_range("'Bob''s data'!A1:B2");
+    CHECK(range.sheet_name == "Bob's data");
+    CHECK(range.first_row == 1 && range.last_row == 2);
+    CHECK(range.first_column == 1 && range.last_column == 2);
+
+    // Names round trip through quote_sheet_name, including names made of quotes or holding a !
+    for (std::string name : {"Bob's data", "It''s", "'", "''", "'quoted'", "a!b", "Sheet1"}) {
+        auto quoted = quote_sheet_name(name);
+        CHECK(parse_sheet_range(quoted + "!A1:B2").sheet_name == name);
+        CHECK(parse_sheet_range(quoted + "!A1:B2").last_row == 2);
+    }
+    CHECK(quote_sheet_name("Bob's data") == "'Bob''s data'");
+}
+
+int main() {
+    TestParseRange();
+    TestQuotedSheetNames();
+    return FinishChecks();
+}